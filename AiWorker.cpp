@@ -0,0 +1,118 @@
+#include "AiWorker.h"
+
+AiWorker::AiWorker()
+    : quit(false),
+      ai(nullptr),
+      lastMove(),
+      limits(),
+      pondering(false),
+      pending(false),
+      dropReply(false),
+      reply(),
+      state(kIdle),
+      thread(&AiWorker::loop, this)
+{
+}
+
+AiWorker::~AiWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        limits.stop.requestStop();
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+bool AiWorker::start(AnytimeStrategy& strategy, const Move& table, SearchLimits request) {
+    return submit(strategy, table, request, false);
+}
+
+bool AiWorker::ponder(AnytimeStrategy& strategy, SearchLimits request) {
+    return submit(strategy, Move(), request, true);
+}
+
+bool AiWorker::submit(AnytimeStrategy& strategy, const Move& table, SearchLimits request,
+                      bool ponderRequest) {
+    if (!request.stop.cancellable()) {
+        request.stop = StopToken::make();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (state.load(std::memory_order_acquire) != kIdle) {
+            return false;
+        }
+        ai       = &strategy;
+        lastMove = table;
+        limits   = request;
+        pondering = ponderRequest;
+        pending  = true;
+        dropReply = false;
+        state.store(kThinking, std::memory_order_release);
+    }
+    wake.notify_one();
+    return true;
+}
+
+bool AiWorker::poll(Move& out) {
+    if (state.load(std::memory_order_acquire) != kReady) {
+        return false;
+    }
+    out = reply;
+    state.store(kIdle, std::memory_order_release);
+    return true;
+}
+
+void AiWorker::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (state.load(std::memory_order_acquire) == kThinking) {
+        limits.stop.requestStop();
+    }
+}
+
+void AiWorker::discard() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (state.load(std::memory_order_acquire) == kThinking) {
+        limits.stop.requestStop();
+        dropReply = true;
+    } else {
+        state.store(kIdle, std::memory_order_release);
+    }
+}
+
+void AiWorker::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] {
+        return state.load(std::memory_order_acquire) != kThinking;
+    });
+}
+
+void AiWorker::loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return quit || pending; });
+        if (quit) {
+            return;
+        }
+        pending = false;
+        AnytimeStrategy* strategy = ai;
+        const Move table = lastMove;
+        const SearchLimits request = limits;
+        const bool ponderRequest = pondering;
+
+        lock.unlock();
+        Move mv;
+        if (ponderRequest) {
+            strategy->ponder(request);
+        } else {
+            mv = strategy->think(table, request);
+        }
+        lock.lock();
+
+        reply = mv;
+        const bool keep = !ponderRequest && !dropReply;
+        dropReply = false;
+        state.store(keep ? kReady : kIdle, std::memory_order_release);
+        done.notify_all();
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef AIWORKER_H
+#define AIWORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "Anytime.h"
+#include "Card.h"
+
+// =========================
+// Background AI thread
+// =========================
+//
+// Runs AnytimeStrategy::think on its own thread, so a caller with a frame
+// loop (the SFML GUI) never blocks on a decision. One request at a time:
+// start() hands the request over and returns at once; the reply is left in
+// a one-slot mailbox that the caller polls every frame with poll(), which
+// takes it without locking.
+//
+// ponder() runs AnytimeStrategy::ponder the same way, for the opponent's
+// turn; it leaves no reply, and the caller discard()s it when the opponent
+// moves (the stop flag is polled every few playouts, so that is quick).
+//
+// discard() never blocks: it raises the stop flag and marks the reply to be
+// dropped, so a caller past its deadline can play the strategy's
+// bestSoFar() at once. The worker stays busy() until the request actually
+// returns, which on a starved machine may be later.
+//
+// While a request runs, the strategy reads its hand and the attached game
+// state, so the caller must not change either until the request is over:
+// the reply taken, or busy() false (waitIdle() blocks for that). Keeping
+// the attached state a copy of the real one lets the caller carry on with
+// the game meanwhile. Everything else may run concurrently.
+
+class AiWorker {
+public:
+    AiWorker();
+    // cancels the running request and joins the thread
+    ~AiWorker();
+
+    AiWorker(const AiWorker&) = delete;
+    AiWorker& operator=(const AiWorker&) = delete;
+
+    // Start ai.think(lastMove, limits). False if a request is still running
+    // or its reply has not been taken. Requests without a stop token get
+    // one, so cancel() always works.
+    bool start(AnytimeStrategy& ai, const Move& lastMove, SearchLimits limits);
+    // Start ai.ponder(limits); same rules as start(). Nothing to poll.
+    bool ponder(AnytimeStrategy& ai, SearchLimits limits);
+
+    // A request is running, or its reply is waiting in the mailbox.
+    bool busy() const { return state.load(std::memory_order_acquire) != kIdle; }
+    bool thinking() const { return state.load(std::memory_order_acquire) == kThinking; }
+
+    // Take the reply if it is ready; false otherwise (never blocks).
+    bool poll(Move& out);
+
+    // Raise the running request's stop flag; its reply still arrives.
+    void cancel();
+    // Cancel and drop the reply (a waiting one, or the running request's
+    // when it arrives). Returns at once.
+    void discard();
+    // Block until no request runs (a reply may be left to poll()).
+    void waitIdle();
+
+private:
+    enum State : int { kIdle, kThinking, kReady };
+
+    bool submit(AnytimeStrategy& ai, const Move& lastMove, SearchLimits limits, bool ponder);
+    void loop();
+
+    std::mutex              mutex;
+    std::condition_variable wake;   // a request or quit, for the thread
+    std::condition_variable done;   // a request over, for waitIdle()
+    bool                    quit;
+
+    // request: written by start() under the mutex while kIdle
+    AnytimeStrategy*        ai;
+    Move                    lastMove;
+    SearchLimits            limits;
+    bool                    pondering;
+    bool                    pending;
+    bool                    dropReply; // discard()ed while running
+
+    // mailbox: `reply` is written before state becomes kReady (release)
+    Move                    reply;
+    std::atomic<int>        state;
+
+    std::thread             thread; // last: starts after the rest is built
+};
+
+#endif // AIWORKER_H
@@ -0,0 +1,128 @@
+#ifndef ANYTIME_H
+#define ANYTIME_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "Card.h"
+
+// =========================
+// Anytime search control
+// =========================
+//
+// What an AI needs to answer within bounded time, wherever it runs (GUI,
+// simulator, a server): a hard deadline, a cancellation flag that another
+// thread can raise, and a slot holding the best move found so far, which
+// any thread may read at any moment.
+//
+// The searches (EndgameSolver, IsmctsSearch) poll the limits every few
+// hundred nodes / few playouts, a few microseconds apart, and return what
+// they have. An AnytimeStrategy publishes a cheap reply before it starts
+// searching, so there is always a legal move to take, even if the search
+// thread is starved by a loaded machine and misses its own deadline: the
+// caller can stop waiting, read bestSoFar() and cancel.
+
+// Shared stop flag: copies refer to the same flag. A default token has no
+// flag and never stops (no allocation for callers that do not cancel).
+class StopToken {
+public:
+    StopToken() = default;
+    static StopToken make() {
+        StopToken t;
+        t.flag = std::make_shared<std::atomic<bool>>(false);
+        return t;
+    }
+
+    void requestStop() const {
+        if (flag) flag->store(true, std::memory_order_release);
+    }
+    bool stopRequested() const {
+        return flag && flag->load(std::memory_order_acquire);
+    }
+    // false for a default token (requestStop does nothing)
+    bool cancellable() const { return flag != nullptr; }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+struct SearchLimits {
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point deadline = Clock::time_point::max(); // max: none
+    StopToken         stop;
+
+    // deadline `ms` milliseconds from now
+    static SearchLimits within(double ms) {
+        SearchLimits l;
+        l.deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double, std::milli>(ms));
+        return l;
+    }
+
+    bool hasDeadline() const { return deadline != Clock::time_point::max(); }
+    // cancelled, or out of time (reads the clock only if there is a deadline)
+    bool expired() const {
+        return stop.stopRequested() || (hasDeadline() && Clock::now() >= deadline);
+    }
+    // the earlier of the deadline and `start + ms` (ms <= 0: the deadline)
+    Clock::time_point capped(Clock::time_point start, double ms) const {
+        if (ms <= 0.0) {
+            return deadline;
+        }
+        Clock::time_point own = start + std::chrono::duration_cast<Clock::duration>(
+                                            std::chrono::duration<double, std::milli>(ms));
+        return own < deadline ? own : deadline;
+    }
+};
+
+// Best move so far, lock-free: a move is its card set (one 64-bit word),
+// and the pattern is recovered with analyzeHand when it is read.
+class BestMove {
+public:
+    BestMove() : bits(kNone) {}
+    // copies take the current value (players are copied / moved as values)
+    BestMove(const BestMove& o) : bits(o.bits.load(std::memory_order_relaxed)) {}
+    BestMove& operator=(const BestMove& o) {
+        bits.store(o.bits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    void clear() { bits.store(kNone, std::memory_order_relaxed); }
+    void publish(CardSet cards) { bits.store(cards.bits(), std::memory_order_release); }
+
+    bool has() const { return bits.load(std::memory_order_acquire) != kNone; }
+    // Pass if nothing was published
+    Move move() const {
+        std::uint64_t b = bits.load(std::memory_order_acquire);
+        if (b == kNone || b == 0) {
+            return Move();
+        }
+        CardSet cards(b);
+        auto info = analyzeHand(cards);
+        return Move(info.first, cards, info.second);
+    }
+
+private:
+    static constexpr std::uint64_t kNone = ~0ull; // not a card set
+    std::atomic<std::uint64_t> bits;
+};
+
+// An AI that can be given a deadline and cancelled, and asked for its
+// current best move while it thinks.
+class AnytimeStrategy {
+public:
+    virtual ~AnytimeStrategy() = default;
+
+    // A legal reply to `lastMove`, returned by `limits.deadline` or soon
+    // after `limits.stop` is raised. Does not change the player's hand.
+    virtual Move think(const Move& lastMove, const SearchLimits& limits) = 0;
+    // What think() would answer if stopped now; safe from any thread.
+    virtual Move bestSoFar() const = 0;
+    // Use an opponent's turn to prepare the next think(), until the limits
+    // say stop. Must not change anything think() would not. Default: idle.
+    virtual void ponder(const SearchLimits& limits) { (void)limits; }
+};
+
+#endif // ANYTIME_H
@@ -0,0 +1,219 @@
+#include "Bidding.h"
+
+#include <chrono>
+#include <stdexcept>
+#include "Deck.h"
+#include "Engine.h"
+#include "MoveGen.h"
+#include "Rng.h"
+#include "Scheduler.h"
+
+namespace {
+
+// fixed, so a rollout budget gives the same estimate on any core count
+constexpr int kChunks = 64;
+// bomb an opponent's play only when it has this many cards or fewer
+constexpr int kBombAtCards = 5;
+
+bool isBomb(const Move& mv) {
+    return mv.type == HandType::Bomb || mv.type == HandType::Rocket;
+}
+
+// lowest bomb, then the rocket; -1 if none
+int lowestBomb(const MoveList& moves) {
+    int best = -1;
+    for (int i = 0; i < moves.size(); ++i) {
+        const Move& mv = moves[i];
+        if (!isBomb(mv)) {
+            continue;
+        }
+        if (best < 0 || mv.type < moves[best].type ||
+            (mv.type == moves[best].type && mv.mainRank < moves[best].mainRank)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// The rule policy of every seat in a rollout (see Bidding.h).
+int rolloutMove(const GameState& s, const MoveList& moves, Xoshiro256& rng) {
+    const int n = moves.size();
+    const int seat = s.currentPlayer();
+    const CardSet hand = s.hand(seat);
+    for (int i = 0; i < n; ++i) {
+        if (moves[i].cardSet == hand) {
+            return i;
+        }
+    }
+    if ((rng() & 7) == 0) {
+        return static_cast<int>(rng.below(static_cast<std::uint32_t>(n)));
+    }
+
+    const Move& table = s.lastMove();
+    if (table.type == HandType::Pass) {
+        // lead: most cards, then lowest rank; bombs only when nothing else
+        int best = -1;
+        int bestScore = 0;
+        for (int i = 0; i < n; ++i) {
+            const Move& mv = moves[i];
+            if (isBomb(mv)) {
+                continue;
+            }
+            int score = mv.cardSet.size() * 32 - mv.mainRank;
+            if (best < 0 || score > bestScore) {
+                best = i;
+                bestScore = score;
+            }
+        }
+        return best >= 0 ? best : lowestBomb(moves);
+    }
+
+    int pass = -1;
+    for (int i = 0; i < n; ++i) {
+        if (moves[i].type == HandType::Pass) {
+            pass = i;
+            break;
+        }
+    }
+    const int opponent = s.lastMovePlayer();
+    if (s.sameTeam(seat, opponent)) {
+        return pass;
+    }
+    // follow: lowest same-type reply
+    int best = -1;
+    for (int i = 0; i < n; ++i) {
+        const Move& mv = moves[i];
+        if (mv.type == table.type && !isBomb(mv) &&
+            (best < 0 || mv.mainRank < moves[best].mainRank)) {
+            best = i;
+        }
+    }
+    if (best >= 0) {
+        return best;
+    }
+    if (s.handSize(opponent) <= kBombAtCards) {
+        int bomb = lowestBomb(moves);
+        if (bomb >= 0) {
+            return bomb;
+        }
+    }
+    return pass;
+}
+
+// One deal of the unseen cards and one game: does the landlord (seat 0,
+// holding `hand` plus the bottom) win?
+bool rollout(CardSet hand, CardId* unseen, int unseenCount, Xoshiro256& rng,
+             GameState& s, MoveList& moves) {
+    // partial Fisher-Yates: 3 bottom cards, then the first peasant's 17
+    CardSet hands[3];
+    hands[0] = hand;
+    const int dealt = kBottomCardCount + kInitialHandSize;
+    for (int i = 0; i < dealt; ++i) {
+        int j = i + static_cast<int>(rng.below(static_cast<std::uint32_t>(unseenCount - i)));
+        CardId t = unseen[i];
+        unseen[i] = unseen[j];
+        unseen[j] = t;
+        hands[i < kBottomCardCount ? 0 : 1].add(unseen[i]);
+    }
+    for (int i = dealt; i < unseenCount; ++i) {
+        hands[2].add(unseen[i]);
+    }
+    s.reset(hands, 0);
+
+    while (!s.isTerminal()) {
+        s.legalMoves(moves);
+        s.apply(moves[rolloutMove(s, moves, rng)]);
+    }
+    return s.landlordWon();
+}
+
+} // namespace
+
+BidEvaluator::BidEvaluator(const BidOptions& o)
+    : opts(o)
+{
+    if (opts.budgetMs <= 0.0 && opts.rollouts <= 0) {
+        throw std::invalid_argument("BidOptions: need a time or rollout budget");
+    }
+}
+
+BidEstimate BidEvaluator::evaluate(CardSet hand, std::uint64_t seed) const {
+    auto start = std::chrono::steady_clock::now();
+    const bool timed = opts.budgetMs > 0.0;
+    const auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                      std::chrono::duration<double, std::milli>(opts.budgetMs));
+
+    CardId pool[kCardCount];
+    int poolSize = 0;
+    for (CardId id : CardSet::fullDeck() - hand) {
+        pool[poolSize++] = id;
+    }
+
+    long long wins[kChunks] = {};
+    long long played[kChunks] = {};
+    auto chunk = [&](std::size_t i, unsigned) {
+        long long quota = 0;
+        if (opts.rollouts > 0) {
+            quota = opts.rollouts / kChunks + (static_cast<long long>(i) < opts.rollouts % kChunks ? 1 : 0);
+            if (quota == 0) {
+                return;
+            }
+        }
+        Xoshiro256 rng(seed ^ (static_cast<std::uint64_t>(i + 1) * 0x9E3779B97F4A7C15ull));
+        CardId unseen[kCardCount];
+        for (int k = 0; k < poolSize; ++k) {
+            unseen[k] = pool[k];
+        }
+        GameState s;
+        MoveList moves;
+        long long w = 0, n = 0;
+        for (;;) {
+            // look before the first rollout too: chunks that start late do none
+            if (timed && (n & 15) == 0 && std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+            w += rollout(hand, unseen, poolSize, rng, s, moves) ? 1 : 0;
+            ++n;
+            if (quota > 0 && n >= quota) {
+                break;
+            }
+        }
+        wins[i] = w;
+        played[i] = n;
+    };
+    TaskScheduler& sched = opts.scheduler ? *opts.scheduler : TaskScheduler::global();
+    sched.parallelFor(kChunks, 1, chunk);
+
+    BidEstimate e;
+    long long w = 0;
+    for (int i = 0; i < kChunks; ++i) {
+        w += wins[i];
+        e.rollouts += played[i];
+    }
+    e.winRate = e.rollouts > 0 ? static_cast<double>(w) / e.rollouts : 0.0;
+    e.ms = std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start).count();
+    return e;
+}
+
+int BidEvaluator::pickLandlord(const CardSet hands[3], const int* seats, int count,
+                               std::uint64_t seed, BidEstimate* out) const {
+    BidOptions share = opts;
+    share.budgetMs = opts.budgetMs / (count > 0 ? count : 1);
+    BidEvaluator each(share);
+
+    int best = -1;
+    double bestRate = -1.0;
+    for (int k = 0; k < count; ++k) {
+        int seat = seats[k];
+        BidEstimate e = each.evaluate(hands[seat], seed ^ (static_cast<std::uint64_t>(seat) << 56));
+        if (out) {
+            out[seat] = e;
+        }
+        if (e.winRate > bestRate) {
+            bestRate = e.winRate;
+            best = seat;
+        }
+    }
+    return best;
+}
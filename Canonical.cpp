@@ -0,0 +1,60 @@
+#include "Canonical.h"
+
+namespace {
+
+// rank histograms of the seats before `seat`
+RankCounts seatsBelow(const GameState& s, int seat) {
+    RankCounts below;
+    for (int i = 0; i < seat; ++i) {
+        below += RankCounts::of(s.hand(i));
+    }
+    return below;
+}
+
+} // namespace
+
+GameState canonicalState(const GameState& s) {
+    GameState c = s;
+    RankCounts below;
+    for (int i = 0; i < 3; ++i) {
+        RankCounts mine = RankCounts::of(s.hand(i));
+        c.hands[i] = canonicalCards(below, mine);
+        below += mine;
+    }
+    const Move& t = s.tableMove;
+    if (!t.isPass()) {
+        c.tableMove = Move(t.type, canonicalCards(below, RankCounts::of(t.cardSet)), t.mainRank);
+    }
+    // hands keep their rank counts and the table its pattern: same hash
+    return c;
+}
+
+bool isCanonical(const GameState& s) {
+    RankCounts below;
+    for (int i = 0; i < 3; ++i) {
+        RankCounts mine = RankCounts::of(s.hand(i));
+        if (s.hand(i) != canonicalCards(below, mine)) {
+            return false;
+        }
+        below += mine;
+    }
+    const Move& t = s.lastMove();
+    return t.isPass() || t.cardSet == canonicalCards(below, RankCounts::of(t.cardSet));
+}
+
+Move canonicalMove(const GameState& s, const Move& mv) {
+    if (mv.isPass()) {
+        return mv;
+    }
+    RankCounts below = seatsBelow(s, s.currentPlayer());
+    return Move(mv.type, canonicalCards(below, RankCounts::of(mv.cardSet)), mv.mainRank);
+}
+
+Move decanonicalMove(const GameState& s, const Move& canonical) {
+    if (canonical.isPass()) {
+        return canonical;
+    }
+    CardSet hand = s.hand(s.currentPlayer());
+    return Move(canonical.type, takeCounts(hand, RankCounts::of(canonical.cardSet)),
+                canonical.mainRank);
+}
@@ -0,0 +1,54 @@
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include "Engine.h"
+#include "RankCounts.h"
+
+// =========================
+// Suit-canonical game states
+// =========================
+//
+// Suits never decide anything in these rules (jokers have none, straights
+// and pairs ignore them), so swapping the suits of any one rank gives an
+// equivalent position. The canonical representative deals, for every rank,
+// the lowest suits to seat 0, the next ones to seat 1, then seat 2; the
+// table move takes the suits left after that. A state is therefore fully
+// described by its three rank histograms, which is exactly what
+// GameState::hash() hashes: a state, its canonical form and every per-rank
+// suit relabeling of it hash alike.
+//
+// All of it is SWAR over the nibble layout CardSet and RankCounts share
+// (rank r's four suits are the nibble at bit 4 * (r - 3) in both): a count
+// nibble n becomes the suit mask of its n lowest suits in a few operations.
+
+// The n lowest suits of every rank, n = that rank's count.
+inline CardSet lowestSuits(RankCounts c) {
+    std::uint64_t normal = (c.atLeast(1) | c.atLeast(2) << 1 |
+                            c.atLeast(3) << 2 | c.atLeast(4) << 3) & 0x000FFFFFFFFFFFFFull;
+    std::uint64_t w = c.word();
+    std::uint64_t jokers = ((w >> 52) & 1u) << kSmallJokerId |
+                           ((w >> 56) & 1u) << kBigJokerId;
+    return CardSet(normal | jokers);
+}
+
+// The suits of each rank right above the first `below` ones: the canonical
+// cards of a seat whose lower seats hold `below`. below + mine <= 4 per rank.
+inline CardSet canonicalCards(RankCounts below, RankCounts mine) {
+    return lowestSuits(below + mine) - lowestSuits(below);
+}
+
+// The canonical representative of `s` (same hash, same legal patterns,
+// same value for every seat). Turn count and winner are kept.
+GameState canonicalState(const GameState& s);
+bool isCanonical(const GameState& s);
+
+// Move <-> canonical move for the player to move in `s` (the original,
+// not the canonical state). Pass stays Pass.
+// canonicalMove: `mv`'s pattern played from that seat's canonical hand.
+// decanonicalMove: a canonical move back onto the real hand, lowest
+// suits of each rank first (the suits MoveGenerator picks), so
+// decanonicalMove(s, canonicalMove(s, mv)) == mv for generated moves.
+Move canonicalMove(const GameState& s, const Move& mv);
+Move decanonicalMove(const GameState& s, const Move& canonical);
+
+#endif // CANONICAL_H
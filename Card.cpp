@@ -1,6 +1,9 @@
 #include "Card.h"
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <ostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -63,6 +66,23 @@ ostream& operator<<(ostream& os, const Card& c) {
     return os;
 }
 
+CardSet toCardSet(const vector<Card>& cards) {
+    CardSet s;
+    for (const auto& c : cards) {
+        s.add(c.id());
+    }
+    return s;
+}
+
+vector<Card> toCards(CardSet set) {
+    vector<Card> out;
+    out.reserve(static_cast<size_t>(set.size()));
+    for (CardId id : set) {
+        out.push_back(Card::fromId(id));
+    }
+    return out;
+}
+
 // ======================
 // HandType / Move
 // ======================
@@ -101,7 +121,7 @@ bool isStraight(vector<Card> cards) {
     return true;
 }
 
-pair<HandType, int> analyzeHand(const vector<Card>& cards) {
+pair<HandType, int> analyzeHandReference(const vector<Card>& cards) {
     if (cards.empty()) {
         return { HandType::Pass, -1 };
     }
@@ -168,11 +188,190 @@ pair<HandType, int> analyzeHand(const vector<Card>& cards) {
     return { HandType::Invalid, -1 };
 }
 
+// ======================
+// Table-driven analyzeHand
+// ======================
+//
+// A candidate of n <= 5 cards is described by its rank-count signature
+// (c1, c2, c3, c4) = how many ranks appear exactly 1, 2, 3, 4 times.
+// Every signature maps to at most one hand type; the table below is built at
+// compile time and says which type it is and which count level carries the
+// main rank. Only two signatures need a second look at the actual ranks:
+// five distinct ranks (straight?) and two distinct singles (rocket?).
+
+namespace {
+
+enum ShapeCheck : std::uint8_t {
+    kCheckNone,
+    kCheckStraight,
+    kCheckRocket
+};
+
+struct HandShape {
+    HandType     type      = HandType::Invalid;
+    std::uint8_t mainLevel = 0; // main rank = lowest rank with this count
+    ShapeCheck   check     = kCheckNone;
+};
+
+constexpr int shapeIndex(int c1, int c2, int c3, int c4) {
+    return c1 + 6 * (c2 + 3 * (c3 + 2 * c4));
+}
+
+constexpr int kShapeCount = shapeIndex(5, 2, 1, 1) + 1;
+
+constexpr std::array<HandShape, kShapeCount> makeShapeTable() {
+    std::array<HandShape, kShapeCount> t{};
+    t[shapeIndex(1, 0, 0, 0)] = { HandType::Single,    1, kCheckNone };
+    t[shapeIndex(0, 1, 0, 0)] = { HandType::Pair,      2, kCheckNone };
+    t[shapeIndex(2, 0, 0, 0)] = { HandType::Rocket,    0, kCheckRocket };
+    t[shapeIndex(0, 0, 0, 1)] = { HandType::Bomb,      4, kCheckNone };
+    t[shapeIndex(0, 1, 1, 0)] = { HandType::FullHouse, 3, kCheckNone };
+    t[shapeIndex(5, 0, 0, 0)] = { HandType::Straight,  1, kCheckStraight };
+    return t;
+}
+
+constexpr std::array<HandShape, kShapeCount> kShapeTable = makeShapeTable();
+
+} // namespace
+
+pair<HandType, int> classifyCounts(RankCounts counts, int cardCount) {
+    if (cardCount == 0) {
+        return { HandType::Pass, -1 };
+    }
+    if (cardCount > 5) {
+        return { HandType::Invalid, -1 };
+    }
+
+    std::uint64_t ge[6] = { 0, counts.atLeast(1), counts.atLeast(2),
+                            counts.atLeast(3), counts.atLeast(4), 0 };
+    int c[5] = { 0, 0, 0, 0, 0 };
+    for (int k = 1; k <= 4; ++k) {
+        c[k] = RankCounts::rankCount(ge[k] & ~ge[k + 1]);
+    }
+    if (c[1] + 2 * c[2] + 3 * c[3] + 4 * c[4] != cardCount) {
+        return { HandType::Invalid, -1 }; // e.g. duplicate cards
+    }
+
+    const HandShape& shape = kShapeTable[shapeIndex(c[1], c[2], c[3], c[4])];
+    switch (shape.check) {
+    case kCheckRocket:
+        if (!counts.hasRocket()) return { HandType::Invalid, -1 };
+        return { HandType::Rocket, 100 };
+    case kCheckStraight: {
+        std::uint64_t starts = counts.straightStarts(5);
+        if (!starts) return { HandType::Invalid, -1 };
+        return { HandType::Straight, RankCounts::lowestRank(starts) + 4 };
+    }
+    case kCheckNone:
+    default:
+        break;
+    }
+    if (shape.type == HandType::Invalid) {
+        return { HandType::Invalid, -1 };
+    }
+    return { shape.type, RankCounts::lowestRank(ge[shape.mainLevel]) };
+}
+
+pair<HandType, int> analyzeHand(const vector<Card>& cards) {
+    if (cards.size() > 5) {
+        return { HandType::Invalid, -1 };
+    }
+    RankCounts counts;
+    for (const auto& c : cards) {
+        counts.add(c.rank);
+    }
+    return classifyCounts(counts, static_cast<int>(cards.size()));
+}
+
+pair<HandType, int> analyzeHand(CardSet cards) {
+    return classifyCounts(RankCounts::of(cards), cards.size());
+}
+
+long long checkAnalyzeHand(ostream& os) {
+    long long checked = 0;
+    long long mismatches = 0;
+    vector<Card> v;
+    v.reserve(5);
+
+    // walk every subset of at most 5 cards: ids[0] < ids[1] < ...
+    CardId ids[5];
+    auto visit = [&](int n) {
+        v.clear();
+        CardSet s;
+        for (int i = 0; i < n; ++i) {
+            v.push_back(Card::fromId(ids[i]));
+            s.add(ids[i]);
+        }
+        auto ref  = analyzeHandReference(v);
+        auto fast = analyzeHand(v);
+        auto fset = analyzeHand(s);
+        ++checked;
+        if (fast != ref || fset != ref) {
+            if (++mismatches <= 20) {
+                os << "mismatch:";
+                for (const auto& c : v) os << " " << c;
+                os << "  reference=" << handTypeToString(ref.first) << "/" << ref.second
+                   << " table=" << handTypeToString(fast.first) << "/" << fast.second << "\n";
+            }
+        }
+    };
+    auto recurse = [&](auto& self, int depth, int from) -> void {
+        visit(depth);
+        if (depth == 5) return;
+        for (int id = from; id < kCardCount; ++id) {
+            ids[depth] = static_cast<CardId>(id);
+            self(self, depth + 1, id + 1);
+        }
+    };
+    recurse(recurse, 0, 0);
+
+    os << "analyzeHand check: " << checked << " combinations, "
+       << mismatches << " mismatches\n";
+    return mismatches;
+}
+
+void MoveCards::push_back(const Card& c) {
+    if (count_ >= kMaxMoveCards) {
+        throw std::length_error("A move holds at most 5 cards");
+    }
+    ids_[count_++] = c.id();
+}
+
+uint32_t moveKey(HandType t, int length, int mainRank) {
+    uint32_t tier;
+    switch (t) {
+    case HandType::Pass:   return 0;
+    case HandType::Bomb:   tier = 2; break;
+    case HandType::Rocket: tier = 3; break;
+    default:               tier = 1; break;
+    }
+    return (tier << 24) |
+           (static_cast<uint32_t>(t) << 16) |
+           (static_cast<uint32_t>(length & 0xFF) << 8) |
+           static_cast<uint32_t>(mainRank & 0xFF);
+}
+
 Move::Move()
-    : type(HandType::Pass), cards(), mainRank(-1) {}
+    : type(HandType::Pass), cards(), mainRank(-1), key(0), cardSet() {}
 
 Move::Move(HandType t, const vector<Card>& cs, int mr)
-    : type(t), cards(cs), mainRank(mr) {}
+    : type(t), cards(), mainRank(mr), key(0), cardSet()
+{
+    for (const auto& c : cs) {
+        cards.push_back(c);
+        cardSet.add(c.id());
+    }
+    key = moveKey(t, static_cast<int>(cs.size()), mr);
+}
+
+Move::Move(HandType t, CardSet cs, int mr)
+    : type(t), cards(), mainRank(mr), key(0), cardSet(cs)
+{
+    for (CardId id : cs) {
+        cards.push_back(Card::fromId(id));
+    }
+    key = moveKey(t, cs.size(), mr);
+}
 
 bool Move::isPass() const {
     return type == HandType::Pass;
@@ -191,27 +390,12 @@ bool canBeat(const Move& prev, const Move& now) {
         return true;
     }
 
-    if (prev.type == HandType::Rocket) {
-        return false;
-    }
-    if (now.type == HandType::Rocket) {
-        return true;
-    }
-
-    if (now.type == HandType::Bomb && prev.type != HandType::Bomb) {
-        return true;
+    // Higher tier wins outright (bomb > normal, rocket > everything).
+    // Same tier: type and length must match, then the main rank decides.
+    uint32_t nowTier  = now.key >> 24;
+    uint32_t prevTier = prev.key >> 24;
+    if (nowTier != prevTier) {
+        return nowTier > prevTier;
     }
-
-    if (now.type == HandType::Bomb && prev.type == HandType::Bomb) {
-        return now.mainRank > prev.mainRank;
-    }
-
-    if (now.type != prev.type) {
-        return false;
-    }
-    if (now.cards.size() != prev.cards.size()) {
-        return false;
-    }
-
-    return now.mainRank > prev.mainRank;
+    return (now.key >> 8) == (prev.key >> 8) && now.key > prev.key;
 }
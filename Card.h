@@ -4,7 +4,12 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
 #include <iosfwd>
+#include "CardSet.h"
+#include "RankCounts.h"
 
 enum class Suit {
     Spade,
@@ -22,13 +27,21 @@ struct Card {
 
     Card(Suit s = Suit::Spade, int r = 3);
 
+    CardId id() const { return makeCardId(rank, static_cast<int>(suit)); }
+    static Card fromId(CardId id) {
+        return Card(static_cast<Suit>(cardIdSuitIndex(id)), cardIdRank(id));
+    }
+
     std::string toString() const;
     bool operator<(const Card& other) const;
 };
 
 std::ostream& operator<<(std::ostream& os, const Card& c);
 
-enum class HandType {
+CardSet toCardSet(const std::vector<Card>& cards);
+std::vector<Card> toCards(CardSet set); // sorted by rank
+
+enum class HandType : std::uint8_t {
     Invalid,
     Pass,
     Single,
@@ -44,18 +57,70 @@ std::string handTypeToString(HandType t);
 bool isStraight(std::vector<Card> cards);
 
 // returns (hand type, main rank)
+// Table-driven: classifies by the rank-count signature, no sort / copy.
 std::pair<HandType, int> analyzeHand(const std::vector<Card>& cards);
+std::pair<HandType, int> analyzeHand(CardSet cards);
+std::pair<HandType, int> classifyCounts(RankCounts counts, int cardCount);
+
+// Original sort-and-compare classifier, kept as the reference oracle.
+std::pair<HandType, int> analyzeHandReference(const std::vector<Card>& cards);
+
+// Runs every 0..5-card combination of the deck through analyzeHand and
+// analyzeHandReference; prints mismatches to `os`, returns how many.
+long long checkAnalyzeHand(std::ostream& os);
+
+// Largest legal hand (straight / full house)
+constexpr int kMaxMoveCards = 5;
+
+// Inline card list of a Move: no heap, trivially copyable.
+// Iterating yields Card values in the order they were added.
+class MoveCards {
+public:
+    MoveCards() : ids_(), count_(0) {}
+
+    std::size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    Card operator[](std::size_t i) const { return Card::fromId(ids_[i]); }
+
+    void push_back(const Card& c);
+
+    class iterator {
+    public:
+        explicit iterator(const CardId* p) : p_(p) {}
+        Card operator*() const { return Card::fromId(*p_); }
+        iterator& operator++() { ++p_; return *this; }
+        bool operator!=(const iterator& o) const { return p_ != o.p_; }
+    private:
+        const CardId* p_;
+    };
+    iterator begin() const { return iterator(ids_); }
+    iterator end() const { return iterator(ids_ + count_); }
+
+private:
+    CardId       ids_[kMaxMoveCards];
+    std::uint8_t count_;
+};
+
+// Packed ordering key: tier(8) | type(8) | length(8) | main rank(8).
+// Tier is 0 for Pass, 1 for normal hands, 2 for bombs, 3 for the rocket.
+std::uint32_t moveKey(HandType t, int length, int mainRank);
 
 struct Move {
     HandType type;
-    std::vector<Card> cards;
+    MoveCards cards;
     int mainRank;
+    std::uint32_t key;
+    CardSet cardSet; // same cards as `cards`
 
     Move();
     Move(HandType t, const std::vector<Card>& cs, int mr);
+    Move(HandType t, CardSet cs, int mr);
     bool isPass() const;
 };
 
+static_assert(std::is_trivially_copyable<Move>::value,
+              "Move must stay memcpy-able (search / logging copy it freely)");
+
 bool canBeat(const Move& prev, const Move& now);
 
 #endif // CARD_H
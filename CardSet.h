@@ -0,0 +1,135 @@
+#ifndef CARDSET_H
+#define CARDSET_H
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// =========================
+// 1-byte card id / 54-bit card set
+// =========================
+//
+// Card id layout (one bit per physical card in CardSet):
+//   id = (rank - 3) * 4 + suit   for rank 3..15 (suit = Spade, Heart, Club, Diamond)
+//   id = 52                      small joker (rank 16)
+//   id = 53                      big joker   (rank 17)
+//
+// Each normal rank therefore owns one 4-bit nibble, ordered by rank, so
+// iterating a set from the lowest bit yields cards sorted by rank.
+
+using CardId = std::uint8_t;
+
+constexpr int    kCardCount     = 54;
+constexpr CardId kSmallJokerId  = 52;
+constexpr CardId kBigJokerId    = 53;
+
+inline int popcount64(std::uint64_t x) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(x));
+#else
+    return __builtin_popcountll(x);
+#endif
+}
+
+// x must be non-zero
+inline int ctz64(std::uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+constexpr CardId makeCardId(int rank, int suitIndex) {
+    return rank <= 15 ? static_cast<CardId>((rank - 3) * 4 + suitIndex)
+                      : static_cast<CardId>(kSmallJokerId + (rank - 16));
+}
+
+constexpr int cardIdRank(CardId id) {
+    return id < kSmallJokerId ? 3 + id / 4 : 16 + (id - kSmallJokerId);
+}
+
+// 0..3 for normal cards, 4 for jokers (same order as enum class Suit)
+constexpr int cardIdSuitIndex(CardId id) {
+    return id < kSmallJokerId ? id % 4 : 4;
+}
+
+class CardSet {
+public:
+    constexpr CardSet() : bits_(0) {}
+    constexpr explicit CardSet(std::uint64_t bits) : bits_(bits) {}
+
+    static constexpr CardSet fullDeck() { return CardSet((std::uint64_t{1} << kCardCount) - 1); }
+    static constexpr CardSet single(CardId id) { return CardSet(std::uint64_t{1} << id); }
+
+    // All cards of one rank (3..17)
+    static constexpr CardSet ofRank(int rank) {
+        return rank <= 15 ? CardSet(std::uint64_t{0xF} << ((rank - 3) * 4))
+                          : single(makeCardId(rank, 4));
+    }
+
+    constexpr std::uint64_t bits() const { return bits_; }
+
+    constexpr bool empty() const { return bits_ == 0; }
+    int size() const { return popcount64(bits_); }
+
+    constexpr bool contains(CardId id) const { return (bits_ >> id) & 1u; }
+    constexpr bool containsAll(CardSet o) const { return (bits_ & o.bits_) == o.bits_; }
+
+    void add(CardId id)    { bits_ |=  (std::uint64_t{1} << id); }
+    void remove(CardId id) { bits_ &= ~(std::uint64_t{1} << id); }
+
+    // lowest card id; set must be non-empty
+    CardId lowest() const { return static_cast<CardId>(ctz64(bits_)); }
+    CardId popLowest() {
+        CardId id = lowest();
+        bits_ &= bits_ - 1;
+        return id;
+    }
+
+    // The `n` lowest cards of `rank` in this set (fewer if not enough)
+    CardSet takeOfRank(int rank, int n) const {
+        std::uint64_t m = bits_ & ofRank(rank).bits_;
+        std::uint64_t out = 0;
+        for (int i = 0; i < n && m; ++i) {
+            out |= m & (~m + 1);
+            m &= m - 1;
+        }
+        return CardSet(out);
+    }
+
+    constexpr CardSet operator|(CardSet o) const { return CardSet(bits_ | o.bits_); }
+    constexpr CardSet operator&(CardSet o) const { return CardSet(bits_ & o.bits_); }
+    constexpr CardSet operator^(CardSet o) const { return CardSet(bits_ ^ o.bits_); }
+    constexpr CardSet operator-(CardSet o) const { return CardSet(bits_ & ~o.bits_); }
+
+    CardSet& operator|=(CardSet o) { bits_ |= o.bits_; return *this; }
+    CardSet& operator&=(CardSet o) { bits_ &= o.bits_; return *this; }
+    CardSet& operator-=(CardSet o) { bits_ &= ~o.bits_; return *this; }
+
+    constexpr bool operator==(CardSet o) const { return bits_ == o.bits_; }
+    constexpr bool operator!=(CardSet o) const { return bits_ != o.bits_; }
+
+    // for (CardId id : set) — ascending id, i.e. sorted by rank
+    class iterator {
+    public:
+        explicit iterator(std::uint64_t b) : b_(b) {}
+        CardId operator*() const { return static_cast<CardId>(ctz64(b_)); }
+        iterator& operator++() { b_ &= b_ - 1; return *this; }
+        bool operator!=(const iterator& o) const { return b_ != o.b_; }
+    private:
+        std::uint64_t b_;
+    };
+    iterator begin() const { return iterator(bits_); }
+    iterator end() const { return iterator(0); }
+
+private:
+    std::uint64_t bits_;
+};
+
+#endif // CARDSET_H
@@ -0,0 +1,134 @@
+#include "CardTracker.h"
+
+// ======================
+// CardTracker
+// ======================
+
+CardTracker::CardTracker()
+    : playedBy(),
+      voidCards(),
+      bottomCards(),
+      sizes{ 0, 0, 0 },
+      landlordIndex(-1) {}
+
+void CardTracker::start(CardSet bottom, int landlord) {
+    for (int i = 0; i < 3; ++i) {
+        playedBy[i]  = CardSet();
+        voidCards[i] = CardSet();
+        sizes[i]     = kInitialHandSize;
+    }
+    sizes[landlord] += bottom.size();
+    bottomCards   = bottom;
+    landlordIndex = landlord;
+}
+
+void CardTracker::observe(const GameState& before, const Move& mv) {
+    int seat = before.currentPlayer();
+    if (!mv.isPass()) {
+        playedBy[seat] |= mv.cardSet;
+        sizes[seat]    -= mv.cardSet.size();
+        // it played a card we assumed it did not have: the guess was wrong
+        if (!(voidCards[seat] & mv.cardSet).empty()) {
+            voidCards[seat] = CardSet();
+        }
+        return;
+    }
+
+    // Passing on an opponent's single: assume no higher card.
+    // (Passing on a partner's move says nothing.)
+    const Move& table = before.lastMove();
+    if (table.type == HandType::Single &&
+        !before.sameTeam(seat, before.lastMovePlayer())) {
+        std::uint64_t above = 0;
+        for (int r = table.mainRank + 1; r <= 17; ++r) {
+            above |= CardSet::ofRank(r).bits();
+        }
+        voidCards[seat] |= CardSet(above);
+    }
+}
+
+// ======================
+// HandSampler
+// ======================
+
+HandSampler::HandSampler()
+    : seatA(-1), seatB(-1), handSizeA(0), handSizeB(0), needA(0),
+      forcedA(), forcedB(),
+      freeIds(), freeCount(0),
+      prepared(false), relaxedVoids(false) {}
+
+// Split `unseen` between A and B; false if the sizes cannot be met.
+bool HandSampler::split(CardSet unseen, CardSet knownA, CardSet knownB,
+                        CardSet voidA, CardSet voidB) {
+    // a card B cannot hold goes to A and vice versa; known cards win
+    forcedA = unseen & (knownA | (voidB - voidA - knownB));
+    forcedB = unseen & (knownB | (voidA - voidB - knownA));
+    CardSet both = unseen & ((voidA & voidB) - knownA - knownB);
+    if (!both.empty() || !(forcedA & forcedB).empty()) {
+        return false;
+    }
+    CardSet free = unseen - forcedA - forcedB;
+
+    needA = handSizeA - forcedA.size();
+    int needB = handSizeB - forcedB.size();
+    if (needA < 0 || needB < 0 || needA + needB != free.size()) {
+        return false;
+    }
+
+    freeCount = 0;
+    for (CardId id : free) {
+        freeIds[freeCount++] = id;
+    }
+    return true;
+}
+
+bool HandSampler::prepare(const CardTracker& t, const GameState& state, int me) {
+    prepared     = false;
+    relaxedVoids = false;
+    seatA = GameState::nextSeat(me);
+    seatB = GameState::nextSeat(seatA);
+    handSizeA = state.handSize(seatA);
+    handSizeB = state.handSize(seatB);
+
+    // everything not played and not in my hand is with A or B
+    CardSet unseen = CardSet::fullDeck() - t.played() - state.hand(me);
+    if (t.handSize(seatA) != handSizeA || t.handSize(seatB) != handSizeB ||
+        unseen.size() != handSizeA + handSizeB) {
+        return false;
+    }
+
+    CardSet kA = t.known(seatA), kB = t.known(seatB);
+    CardSet vA = t.voids(seatA), vB = t.voids(seatB);
+    if (split(unseen, kA, kB, vA, vB)) {
+        prepared = true;
+        return true;
+    }
+
+    relaxedVoids = true;
+    prepared = split(unseen, kA, kB, CardSet(), vB) ||
+               split(unseen, kA, kB, vA, CardSet()) ||
+               split(unseen, kA, kB, CardSet(), CardSet());
+    return prepared;
+}
+
+void HandSampler::sample(GameState& s, Xoshiro256& rng) const {
+    // partial Fisher-Yates on a copy: the first needA free cards go to A
+    CardId ids[kCardCount];
+    for (int i = 0; i < freeCount; ++i) {
+        ids[i] = freeIds[i];
+    }
+    CardSet handA = forcedA;
+    for (int i = 0; i < needA; ++i) {
+        int j = i + static_cast<int>(rng.below(static_cast<std::uint32_t>(freeCount - i)));
+        CardId tmp = ids[i];
+        ids[i] = ids[j];
+        ids[j] = tmp;
+        handA.add(ids[i]);
+    }
+    CardSet handB = forcedB;
+    for (int i = needA; i < freeCount; ++i) {
+        handB.add(ids[i]);
+    }
+    s.setHand(seatA, handA);
+    s.setHand(seatB, handB);
+}
@@ -0,0 +1,92 @@
+#ifndef CARDTRACKER_H
+#define CARDTRACKER_H
+
+#include "Engine.h"
+#include "Rng.h"
+
+// =========================
+// Card tracker (public information)
+// =========================
+//
+// Everything the table has seen, updated once per move:
+//   - the cards each seat has played and how many it still holds,
+//   - the bottom cards, which everyone saw go to the landlord,
+//   - "voids" read from passes: a seat that passes on an opponent's single
+//     is assumed to hold nothing higher. This is a guess (players do hold
+//     back bombs and high cards), so samplers may drop it.
+// It holds no private hand, so one tracker serves every seat.
+
+class CardTracker {
+public:
+    CardTracker();
+
+    // New game: `bottom` went to `landlord`, hands hold 17 / 17 / 17 + 3.
+    void start(CardSet bottom, int landlord);
+
+    // Call before state.apply(mv), with the state the move is made in.
+    void observe(const GameState& before, const Move& mv);
+
+    int landlord() const { return landlordIndex; }
+    int handSize(int seat) const { return sizes[seat]; }
+    CardSet played() const { return playedBy[0] | playedBy[1] | playedBy[2]; }
+    CardSet played(int seat) const { return playedBy[seat]; }
+
+    // Cards `seat` is known to hold: the landlord's unplayed bottom cards
+    CardSet known(int seat) const {
+        return seat == landlordIndex ? bottomCards - playedBy[seat] : CardSet();
+    }
+    // Cards `seat` is assumed not to hold (pass voids)
+    CardSet voids(int seat) const { return voidCards[seat]; }
+
+private:
+    CardSet playedBy[3];
+    CardSet voidCards[3];
+    CardSet bottomCards;
+    int     sizes[3];
+    int     landlordIndex;
+};
+
+// =========================
+// Constrained hidden-hand sampler
+// =========================
+//
+// Deals the cards one seat cannot see to the other two seats, uniformly
+// among the deals that respect the tracker. No rejection: prepare() splits
+// the unseen cards into "must go to a", "must go to b" and "free" once per
+// decision, and each sample is one partial Fisher-Yates pass over the free
+// cards, so late-game constraints cost nothing extra.
+//
+// If the voids make the hand sizes impossible, they are dropped (first the
+// seat that overflows, then both); known bottom cards are never dropped.
+
+class HandSampler {
+public:
+    HandSampler();
+
+    // Observer `me` holds `myHand`; `state` gives the current hand sizes.
+    // Returns false when the tracker does not match the state (then the
+    // sampler must not be used).
+    bool prepare(const CardTracker& t, const GameState& state, int me);
+
+    // Writes the sampled hands of the two other seats into `s`.
+    void sample(GameState& s, Xoshiro256& rng) const;
+
+    bool ready() const { return prepared; }
+    // true when some pass voids had to be ignored
+    bool relaxed() const { return relaxedVoids; }
+
+private:
+    bool split(CardSet unseen, CardSet knownA, CardSet knownB,
+               CardSet voidA, CardSet voidB);
+
+    int     seatA, seatB;
+    int     handSizeA, handSizeB;
+    int     needA;             // free cards still to give to seat A
+    CardSet forcedA, forcedB;
+    CardId  freeIds[kCardCount];
+    int     freeCount;
+    bool    prepared;
+    bool    relaxedVoids;
+};
+
+#endif // CARDTRACKER_H
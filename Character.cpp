@@ -1,10 +1,13 @@
 #include "Character.h"
+#include "Decompose.h"
+#include "Engine.h"
+#include "MoveGen.h"
 
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 #include <stdexcept>
 #include <limits>
-#include <map>
 #include <sstream>
 #include <random>
 
@@ -19,10 +22,27 @@ CardCharacter::CardCharacter(const std::string& n)
 
 void CardCharacter::addCard(const Card& c) {
     hand.push_back(c);
+    handSet.add(c.id());
+    handCounts.add(c.rank);
+}
+
+void CardCharacter::addCards(CardSet cards) {
+    for (CardId id : cards) {
+        hand.push_back(Card::fromId(id));
+    }
+    handSet |= cards;
+    handCounts += RankCounts::of(cards);
+}
+
+void CardCharacter::clearHand() {
+    hand.clear();
+    handSet    = CardSet();
+    handCounts = RankCounts();
 }
 
 void CardCharacter::sortHand() {
-    std::sort(hand.begin(), hand.end());
+    // card ids are ordered by rank, so the set already is the sorted hand
+    hand = toCards(handSet);
 }
 
 void CardCharacter::printHand() const {
@@ -58,10 +78,29 @@ std::vector<Card> CardCharacter::playCardsByIndices(const std::vector<int>& indi
     for (int i = static_cast<int>(idx.size()) - 1; i >= 0; --i) {
         hand.erase(hand.begin() + idx[i]);
     }
+    CardSet chosenSet = toCardSet(chosen);
+    handSet -= chosenSet;
+    handCounts -= RankCounts::of(chosenSet);
 
     return chosen;
 }
 
+std::vector<Card> CardCharacter::playCards(CardSet cards) {
+    removeCards(cards);
+    return toCards(cards);
+}
+
+void CardCharacter::removeCards(CardSet cards) {
+    if (!handSet.containsAll(cards)) {
+        throw std::invalid_argument("removeCards: cards are not in hand");
+    }
+    hand.erase(std::remove_if(hand.begin(), hand.end(),
+                              [cards](const Card& c) { return cards.contains(c.id()); }),
+               hand.end());
+    handSet -= cards;
+    handCounts -= RankCounts::of(cards);
+}
+
 // =====================
 // Player (human)
 // =====================
@@ -201,357 +240,241 @@ Move Player::playTurn(const Move& lastMove) {
 // Enemy (AI) smarter play
 // ======================
 
-bool Enemy::findSingleGreater(int targetRank, std::vector<int>& outIdx) const {
-    const auto& h = hand;
-    for (std::size_t i = 0; i < h.size(); ++i) {
-        if (h[i].rank > targetRank) {
-            outIdx = { static_cast<int>(i) };
-            return true;
-        }
-    }
-    return false;
+namespace {
+
+// searches stop this long before a deadline, to hand the reply back in time
+constexpr double kReplyMarginMs = 1.0;
+
+} // namespace
+
+Enemy::Enemy(const std::string& n)
+    : Player(n),
+      bombDecisionProb(1.0),
+      rng(std::random_device{}()),
+      verbose(true),
+      table(nullptr),
+      tracker(nullptr),
+      tablebase(nullptr),
+      endgame(),
+      lastSolve(),
+      strategy(AiStrategy::Greedy),
+      mcts(),
+      best(),
+      searched(false) {}
+
+void Enemy::setEndgameSolver(int maxTotalCards, double budgetMs) {
+    SolverOptions o = endgame.options();
+    o.maxTotalCards = maxTotalCards;
+    o.budgetMs      = budgetMs;
+    endgame.setOptions(o);
 }
 
-bool Enemy::findPairGreater(int targetRank, std::vector<int>& outIdx) const {
-    const auto& h = hand;
-    std::size_t n = h.size();
-    std::size_t i = 0;
-    while (i + 1 < n) {
-        int r = h[i].rank;
-        std::size_t j = i + 1;
-        while (j < n && h[j].rank == r) {
-            ++j;
-        }
-        int cnt = static_cast<int>(j - i);
-        if (cnt >= 2 && r > targetRank) {
-            outIdx = { static_cast<int>(i), static_cast<int>(i + 1) };
-            return true;
-        }
-        i = j;
-    }
-    return false;
+void Enemy::setTranspositionTable(TransTable* t) {
+    SolverOptions so = endgame.options();
+    so.table = t;
+    endgame.setOptions(so);
+    MctsOptions mo = mcts.options();
+    mo.table = t;
+    mcts.setOptions(mo);
 }
 
-bool Enemy::findBomb(int targetRank, bool mustGreater, std::vector<int>& outIdx) const {
-    const auto& h = hand;
-    std::size_t n = h.size();
-    std::size_t i = 0;
-    while (i + 3 < n) {
-        int r = h[i].rank;
-        std::size_t j = i + 1;
-        while (j < n && h[j].rank == r) {
-            ++j;
-        }
-        int cnt = static_cast<int>(j - i);
-        if (cnt >= 4) {
-            if (!mustGreater || r > targetRank) {
-                outIdx = {
-                    static_cast<int>(i),
-                    static_cast<int>(i + 1),
-                    static_cast<int>(i + 2),
-                    static_cast<int>(i + 3)
-                };
-                return true;
-            }
-        }
-        i = j;
-    }
-    return false;
+void Enemy::attachTablebase(const Tablebase* tb) {
+    tablebase = tb;
+    SolverOptions so = endgame.options();
+    so.tablebase = tb;
+    endgame.setOptions(so);
+    MctsOptions mo = mcts.options();
+    mo.tablebase = tb;
+    mcts.setOptions(mo);
 }
 
-bool Enemy::findRocket(std::vector<int>& outIdx) const {
-    const auto& h = hand;
-    int idxSmall = -1, idxBig = -1;
-    for (std::size_t i = 0; i < h.size(); ++i) {
-        if (h[i].suit == Suit::Joker) {
-            if (h[i].rank == 16) idxSmall = static_cast<int>(i);
-            if (h[i].rank == 17) idxBig   = static_cast<int>(i);
-        }
-    }
-    if (idxSmall != -1 && idxBig != -1) {
-        outIdx = { idxSmall, idxBig };
-        return true;
-    }
-    return false;
+void Enemy::setThinkTime(double ms) {
+    MctsOptions o = mcts.options();
+    o.budgetMs = ms;
+    mcts.setOptions(o);
 }
 
-bool Enemy::findStraightGreater(int targetHighRank, int length,
-                                std::vector<int>& outIdx) const
-{
-    if (length != 5) return false;
-
-    const auto& h = hand;
-    std::map<int, int> rankToIdx;
-    for (std::size_t i = 0; i < h.size(); ++i) {
-        int r = h[i].rank;
-        if (r < 3 || r > 14) continue; // no 2, no Jokers
-        if (rankToIdx.find(r) == rankToIdx.end()) {
-            rankToIdx[r] = static_cast<int>(i);
-        }
-    }
-    if (rankToIdx.size() < static_cast<std::size_t>(length)) {
-        return false;
-    }
-
-    std::vector<int> ranks;
-    ranks.reserve(rankToIdx.size());
-    for (auto& kv : rankToIdx) {
-        ranks.push_back(kv.first);
-    }
-
-    for (int i = 0; i + length - 1 < static_cast<int>(ranks.size()); ++i) {
-        bool ok = true;
-        for (int j = 0; j + 1 < length; ++j) {
-            if (ranks[i + j + 1] != ranks[i + j] + 1) {
-                ok = false;
-                break;
-            }
-        }
-        if (!ok) continue;
-        int highRank = ranks[i + length - 1];
-        if (highRank > targetHighRank) {
-            outIdx.clear();
-            for (int k = 0; k < length; ++k) {
-                int r = ranks[i + k];
-                outIdx.push_back(rankToIdx[r]);
-            }
-            return true;
-        }
-    }
-    return false;
+bool Enemy::tableInSync(const Move& lastMove) const {
+    return table && !table->isTerminal() &&
+           table->hand(table->currentPlayer()) == handSet &&
+           table->lastMove().key == lastMove.key;
 }
 
-bool Enemy::findFullHouseGreater(int targetTripleRank,
-                                 std::vector<int>& outIdx) const
-{
-    const auto& h = hand;
-    std::map<int, std::vector<int>> rankToIdxList;
-    for (std::size_t i = 0; i < h.size(); ++i) {
-        rankToIdxList[h[i].rank].push_back(static_cast<int>(i));
+double Enemy::bombDecisionProbFor(const GameState& state) {
+    const Move& table = state.lastMove();
+    if (table.type == HandType::Pass ||
+        table.type == HandType::Bomb ||
+        table.type == HandType::Rocket ||
+        state.lastMovePlayer() < 0)
+    {
+        return 1.0;
     }
 
-    for (auto itTriple = rankToIdxList.begin();
-         itTriple != rankToIdxList.end(); ++itTriple)
-    {
-        int rTriple = itTriple->first;
-        if (static_cast<int>(itTriple->second.size()) < 3) continue;
-        if (rTriple <= targetTripleRank) continue;
+    int oppIdx  = state.lastMovePlayer();
+    int current = state.handSize(oppIdx);
+    int start   = kInitialHandSize + (oppIdx == state.landlord() ? kBottomCardCount : 0);
+    double prob = 1.0 - static_cast<double>(current) / static_cast<double>(start);
+    if (prob < 0.0) prob = 0.0;
+    if (prob > 1.0) prob = 1.0;
+    return prob;
+}
 
-        for (auto itPair = rankToIdxList.begin();
-             itPair != rankToIdxList.end(); ++itPair)
-        {
-            int rPair = itPair->first;
-            if (rPair == rTriple) continue;
-            if (static_cast<int>(itPair->second.size()) < 2) continue;
-
-            outIdx.clear();
-            outIdx.push_back(itTriple->second[0]);
-            outIdx.push_back(itTriple->second[1]);
-            outIdx.push_back(itTriple->second[2]);
-            outIdx.push_back(itPair->second[0]);
-            outIdx.push_back(itPair->second[1]);
-            return true;
-        }
+bool Enemy::findBomb(int targetRank, bool mustGreater, CardSet& out) const {
+    std::uint64_t m = handCounts.atLeast(4);
+    if (mustGreater) {
+        m &= RankCounts::ranksAbove(targetRank);
     }
-    return false;
+    if (!m) return false;
+    out = CardSet::ofRank(RankCounts::lowestRank(m));
+    return true;
 }
 
-// --- helpers for opening a new round (lastMove == Pass) ---
-
-// 找任意 5 張順子（盡量出「最小」的）
-bool Enemy::findAnyStraight(int length, std::vector<int>& outIdx) const {
-    if (length != 5) return false;
+bool Enemy::findRocket(CardSet& out) const {
+    if (!handCounts.hasRocket()) return false;
+    out = CardSet::ofRank(16) | CardSet::ofRank(17);
+    return true;
+}
 
-    const auto& h = hand;
-    std::map<int, int> rankToIdx;
-    for (std::size_t i = 0; i < h.size(); ++i) {
-        int r = h[i].rank;
-        if (r < 3 || r > 14) continue; // no 2, no Jokers
-        if (rankToIdx.find(r) == rankToIdx.end()) {
-            rankToIdx[r] = static_cast<int>(i);
+// --- plan-based choices (minimum-plays decomposition) ---
+
+// Lead the group of a minimum-plays plan that holds the lowest card;
+// bombs and the rocket go last. Among groups starting at the same rank,
+// shed the most cards.
+CardSet Enemy::planLead() const {
+    HandPlan plan = HandDecomposer::plan(handCounts);
+    int best = 0;
+    int bestKey = 1 << 30;
+    for (int i = 0; i < plan.plays; ++i) {
+        const PlanGroup& g = plan.groups[i];
+        RankCounts cards(g.pattern);
+        bool power = (g.type == HandType::Bomb || g.type == HandType::Rocket);
+        int key = (power ? 1 << 16 : 0) +
+                  RankCounts::lowestRank(cards.atLeast(1)) * 16 - cards.total();
+        if (key < bestKey) {
+            bestKey = key;
+            best = i;
         }
     }
-    if (rankToIdx.size() < static_cast<std::size_t>(length)) {
-        return false;
-    }
-
-    std::vector<int> ranks;
-    ranks.reserve(rankToIdx.size());
-    for (auto& kv : rankToIdx) {
-        ranks.push_back(kv.first);
-    }
-
-    int bestHigh = 1000;
-    std::vector<int> bestIndices;
+    return takeCounts(handSet, RankCounts(plan.groups[best].pattern));
+}
 
-    for (int i = 0; i + length - 1 < static_cast<int>(ranks.size()); ++i) {
-        bool ok = true;
-        for (int j = 0; j + 1 < length; ++j) {
-            if (ranks[i + j + 1] != ranks[i + j] + 1) {
-                ok = false;
-                break;
-            }
+// Same-type reply after which the rest of the hand needs the fewest plays
+// (ties: the lowest reply). Bombs over a non-bomb are decided separately.
+bool Enemy::findPlanReply(const Move& lastMove, CardSet& out) const {
+    MoveList replies;
+    MoveGenerator::generate(handSet, lastMove, replies);
+    int bestPlays = 1 << 30;
+    for (const Move& mv : replies) {
+        if (mv.type != lastMove.type) {
+            continue;
         }
-        if (!ok) continue;
-        int highRank = ranks[i + length - 1];
-        if (highRank < bestHigh) {
-            bestHigh = highRank;
-            bestIndices.clear();
-            for (int k = 0; k < length; ++k) {
-                int r = ranks[i + k];
-                bestIndices.push_back(rankToIdx[r]);
-            }
+        int plays = HandDecomposer::minPlays(handCounts - RankCounts::of(mv.cardSet));
+        if (plays < bestPlays) {
+            bestPlays = plays;
+            out = mv.cardSet;
         }
     }
-
-    if (bestIndices.empty()) return false;
-    outIdx = bestIndices;
-    return true;
+    return bestPlays != (1 << 30);
 }
 
-// 找任意葫蘆（一樣選 triple 點數最小的）
-bool Enemy::findAnyFullHouse(std::vector<int>& outIdx) const {
-    const auto& h = hand;
-    std::map<int, std::vector<int>> rankToIdxList;
-    for (std::size_t i = 0; i < h.size(); ++i) {
-        rankToIdxList[h[i].rank].push_back(static_cast<int>(i));
-    }
+// --- main AI decision ---
 
-    int bestTripleRank = 1000;
-    std::vector<int> bestIndices;
+CardSet Enemy::chooseCards(const Move& lastMove, bool& savedBomb, const SearchLimits& limits) {
+    lastSolve = SolverResult();
+    searched = false;
 
-    for (auto itTriple = rankToIdxList.begin();
-         itTriple != rankToIdxList.end(); ++itTriple)
-    {
-        int rTriple = itTriple->first;
-        if (static_cast<int>(itTriple->second.size()) < 3) continue;
+    // The greedy answer first: it takes microseconds, and from here on there
+    // is a legal reply to fall back on, whatever happens to the search.
+    CardSet greedy = greedyCards(lastMove, savedBomb);
+    best.publish(greedy);
 
-        for (auto itPair = rankToIdxList.begin();
-             itPair != rankToIdxList.end(); ++itPair)
-        {
-            int rPair = itPair->first;
-            if (rPair == rTriple) continue;
-            if (static_cast<int>(itPair->second.size()) < 2) continue;
-
-            if (rTriple < bestTripleRank) {
-                bestTripleRank = rTriple;
-                bestIndices.clear();
-                bestIndices.push_back(itTriple->second[0]);
-                bestIndices.push_back(itTriple->second[1]);
-                bestIndices.push_back(itTriple->second[2]);
-                bestIndices.push_back(itPair->second[0]);
-                bestIndices.push_back(itPair->second[1]);
-            }
-        }
+    bool synced = tableInSync(lastMove);
+    if (!synced || limits.expired()) {
+        return greedy;
+    }
+    // the searches stop a little early, to leave time to hand the reply back
+    SearchLimits search = limits;
+    if (search.hasDeadline()) {
+        search.deadline -= std::chrono::duration_cast<SearchLimits::Clock::duration>(
+                               std::chrono::duration<double, std::milli>(kReplyMarginMs));
     }
 
-    if (bestIndices.empty()) return false;
-    outIdx = bestIndices;
-    return true;
-}
+    // Tablebase: every hand small enough, the answer is one probe per move
+    if (tablebase && tablebase->covers(*table)) {
+        Move mv;
+        bool win = tablebase->bestMove(*table, mv);
+        if (verbose) {
+            std::cout << "AI [" << name << "] tablebase: " << (win ? "win" : "loss") << "\n";
+        }
+        if (win) {
+            savedBomb = false;
+            best.publish(mv.cardSet);
+            return mv.cardSet; // empty = winning Pass
+        }
+    }
 
-// 開新一輪用的對子選擇：只選 rank <= 13（不會拿 AA / 22 / JokerJoker 開局）
-bool Enemy::findOpeningPair(std::vector<int>& outIdx) const {
-    const auto& h = hand;
-    std::size_t n = h.size();
-    std::size_t i = 0;
-    while (i + 1 < n) {
-        int r = h[i].rank;
-        std::size_t j = i + 1;
-        while (j < n && h[j].rank == r) {
-            ++j;
+    // 0) Endgame: exact search when the attached engine is at our turn
+    if (endgame.applies(*table)) {
+        lastSolve = endgame.solve(*table, search);
+        const SolverResult& r = lastSolve;
+        if (verbose && r.solved) {
+            std::cout << "AI [" << name << "] endgame search: "
+                      << (r.win ? "win" : "loss") << " in " << r.nodes
+                      << " nodes (" << r.ttHits << " table hits), " << r.ms << " ms\n";
+        }
+        if (r.solved && r.win) {
+            savedBomb = false;
+            best.publish(r.best.cardSet);
+            return r.best.cardSet; // empty = winning Pass
         }
-        int cnt = static_cast<int>(j - i);
-        if (cnt >= 2) {
-            // 避免 AA (14), 22 (15), Jokers(16,17)
-            if (r <= 13) {
-                outIdx = { static_cast<int>(i), static_cast<int>(i + 1) };
-                return true;
+        // proven loss or out of time: fall back to the greedy rules
+    }
+
+    // ISMCTS strategy replaces the greedy rules
+    if (strategy == AiStrategy::Ismcts) {
+        Move mv = mcts.choose(*table, rng, tracker, search, &best);
+        searched = true;
+        if (verbose) {
+            const MctsStats& st = mcts.stats();
+            std::cout << "AI [" << name << "] ISMCTS: " << st.playouts
+                      << " playouts in " << st.ms << " ms ("
+                      << static_cast<long long>(st.playoutsPerSec())
+                      << " playouts/s, " << st.nodes << " nodes)\n";
+            if (st.afterPonder) {
+                std::cout << "AI [" << name << "] ponder "
+                          << (st.ponderHit ? "hit: " : "miss: ") << st.reusedNodes
+                          << " nodes / " << st.reusedVisits << " visits reused\n";
             }
         }
-        i = j;
+        savedBomb = false;
+        best.publish(mv.cardSet);
+        return mv.cardSet;
     }
-    return false;
+    return greedy;
 }
 
-// --- main AI decision ---
-
-Move Enemy::playTurn(const Move& lastMove) {
-    std::cout << "\n--- AI [" << name << "] turn ---\n";
-
-    if (hand.empty()) {
-        return Move(); // Pass
-    }
-
-    std::vector<int> idxList;
-    std::vector<Card> played;
-    std::pair<HandType, int> info;
+// Greedy rules: lead from the minimum-plays plan, follow with the same type,
+// bomb / rocket with probability bombDecisionProb.
+CardSet Enemy::greedyCards(const Move& lastMove, bool& savedBomb) {
+    CardSet chosen;
+    savedBomb = false;
 
     // 1) New round: lastMove is Pass
     if (lastMove.type == HandType::Pass) {
-        bool found = false;
-
-        // priority:
-        //   5 cards (Straight > FullHouse) -> opening pair (low ranks) -> single
-        if (findAnyStraight(5, idxList)) {
-            found = true;
-        } else if (findAnyFullHouse(idxList)) {
-            found = true;
-        } else if (findOpeningPair(idxList)) {
-            found = true;
-        } else if (findSingleGreater(-1, idxList)) { // -1 => smallest single
-            found = true;
-        }
-
-        if (!found) {
-            idxList = { 0 };
-        }
-
-        played = playCardsByIndices(idxList);
-        info   = analyzeHand(played);
-
-        std::cout << "AI [" << name << "] plays: ["
-                  << handTypeToString(info.first) << "] ";
-        for (const auto& c : played) std::cout << c << "  ";
-        std::cout << "\n";
-
-        return Move(info.first, played, info.second);
+        return planLead();
     }
 
-    // 2) Following an existing move: try same type first
-    bool found = false;
-
-    if (lastMove.type == HandType::Single) {
-        found = findSingleGreater(lastMove.mainRank, idxList);
-    } else if (lastMove.type == HandType::Pair) {
-        found = findPairGreater(lastMove.mainRank, idxList);
-    } else if (lastMove.type == HandType::Straight) {
-        int len = static_cast<int>(lastMove.cards.size());
-        found = findStraightGreater(lastMove.mainRank, len, idxList);
-    } else if (lastMove.type == HandType::FullHouse) {
-        found = findFullHouseGreater(lastMove.mainRank, idxList);
-    } else if (lastMove.type == HandType::Bomb) {
-        found = findBomb(lastMove.mainRank, true, idxList);
-    } else if (lastMove.type == HandType::Rocket) {
-        found = false; // cannot beat rocket
-    }
+    // 2) Following an existing move: same type first (a bigger bomb over a bomb)
+    bool found = findPlanReply(lastMove, chosen);
 
     if (found) {
-        played = playCardsByIndices(idxList);
-        info   = analyzeHand(played);
-        std::cout << "AI [" << name << "] plays: ["
-                  << handTypeToString(info.first) << "] ";
-        for (const auto& c : played) std::cout << c << "  ";
-        std::cout << "\n";
-        return Move(info.first, played, info.second);
+        return chosen;
     }
 
     // 3) No same-type move: decide whether we are willing to use bomb / rocket
     bool allowBombRocket = true;
     if (bombDecisionProb < 1.0) {
-        static std::mt19937 rng{ std::random_device{}() };
-        std::uniform_real_distribution<double> dist(0.0, 1.0);
-        double r = dist(rng);
+        double r = rng.uniform();
         if (r > bombDecisionProb) {
             allowBombRocket = false;
         }
@@ -560,32 +483,99 @@ Move Enemy::playTurn(const Move& lastMove) {
     if (allowBombRocket) {
         // 先試炸彈
         if (lastMove.type != HandType::Bomb && lastMove.type != HandType::Rocket) {
-            if (findBomb(-1, false, idxList)) {
-                played = playCardsByIndices(idxList);
-                info   = analyzeHand(played);
-                std::cout << "AI [" << name << "] plays: ["
-                          << handTypeToString(info.first) << "] ";
-                for (const auto& c : played) std::cout << c << "  ";
-                std::cout << "\n";
-                return Move(info.first, played, info.second);
+            if (findBomb(-1, false, chosen)) {
+                return chosen;
             }
         }
 
         // 再試火箭
-        if (findRocket(idxList)) {
-            played = playCardsByIndices(idxList);
-            info   = analyzeHand(played);
-            std::cout << "AI [" << name << "] plays: ["
-                      << handTypeToString(info.first) << "] ";
-            for (const auto& c : played) std::cout << c << "  ";
-            std::cout << "\n";
-            return Move(info.first, played, info.second);
+        if (findRocket(chosen)) {
+            return chosen;
         }
     } else {
-        std::cout << "AI [" << name << "] decides to save bomb/rocket.\n";
+        savedBomb = true;
     }
 
     // 4) Really nothing or decided to keep bombs/rocket: Pass
-    std::cout << "AI [" << name << "] chooses Pass.\n";
-    return Move(); // Pass
+    return CardSet();
+}
+
+Move Enemy::playTurn(const Move& lastMove) {
+    return playTurn(lastMove, SearchLimits());
+}
+
+Move Enemy::think(const Move& lastMove, const SearchLimits& limits) {
+    best.clear();
+    if (hand.empty()) {
+        best.publish(CardSet());
+        return Move();
+    }
+    bool savedBomb = false;
+    best.publish(chooseCards(lastMove, savedBomb, limits));
+    return best.move();
+}
+
+Move Enemy::playTurn(const Move& lastMove, const SearchLimits& limits) {
+    if (verbose) {
+        std::cout << "\n--- AI [" << name << "] turn ---\n";
+    }
+
+    best.clear();
+    if (hand.empty()) {
+        return Move(); // Pass
+    }
+
+    bool savedBomb = false;
+    CardSet chosen = chooseCards(lastMove, savedBomb, limits);
+
+    if (chosen.empty()) {
+        if (savedBomb && verbose) {
+            std::cout << "AI [" << name << "] decides to save bomb/rocket.\n";
+        }
+        return playMove(Move()); // Pass
+    }
+    auto info = analyzeHand(chosen);
+    return playMove(Move(info.first, chosen, info.second));
+}
+
+void Enemy::ponder(const SearchLimits& limits) {
+    if (strategy != AiStrategy::Ismcts || !table || table->isTerminal()) {
+        return;
+    }
+    // our seat in the attached engine: the hand that matches ours
+    int me = -1;
+    for (int seat = 0; seat < 3; ++seat) {
+        if (table->hand(seat) == handSet) {
+            me = seat;
+        }
+    }
+    if (me < 0 || me == table->currentPlayer()) {
+        return;
+    }
+    mcts.ponder(*table, me, rng, tracker, limits);
+    if (verbose) {
+        const MctsStats& st = mcts.ponderStats();
+        std::cout << "AI [" << name << "] pondered: " << st.playouts
+                  << " playouts in " << st.ms << " ms\n";
+    }
+}
+
+Move Enemy::playMove(const Move& mv) {
+    best.clear(); // the decision is over; the next one starts empty
+    if (mv.cardSet.empty()) {
+        if (verbose) {
+            std::cout << "AI [" << name << "] chooses Pass.\n";
+        }
+        return Move(); // Pass
+    }
+
+    removeCards(mv.cardSet);
+
+    if (verbose) {
+        std::cout << "AI [" << name << "] plays: ["
+                  << handTypeToString(mv.type) << "] ";
+        for (const auto& c : mv.cards) std::cout << c << "  ";
+        std::cout << "\n";
+    }
+    return mv;
 }
@@ -3,12 +3,19 @@
 
 #include <string>
 #include <vector>
+#include "Anytime.h"
 #include "Card.h"
+#include "RankCounts.h"
+#include "Mcts.h"
+#include "Rng.h"
+#include "Solver.h"
 
 class CardCharacter {
 protected:
     std::string name;
     std::vector<Card> hand;
+    CardSet handSet;       // same cards as `hand`, kept in sync
+    RankCounts handCounts; // rank histogram of `hand`, kept in sync
 
 public:
     CardCharacter(const std::string& n);
@@ -17,6 +24,8 @@ public:
     const std::string& getNameRef() const { return name; }
 
     void addCard(const Card& c);
+    void addCards(CardSet cards);
+    void clearHand();
     void sortHand();
     void printHand() const;
 
@@ -24,9 +33,14 @@ public:
     bool isHandEmpty() const { return hand.empty(); }
 
     const std::vector<Card>& getHand() const { return hand; }
+    CardSet getHandSet() const { return handSet; }
+    RankCounts getHandCounts() const { return handCounts; }
     const Card& getCard(std::size_t index) const;
 
     std::vector<Card> playCardsByIndices(const std::vector<int>& indices);
+    // remove `cards` (must all be in hand); returns them sorted by rank
+    std::vector<Card> playCards(CardSet cards);
+    void removeCards(CardSet cards);
 
     virtual Move playTurn(const Move& lastMove) = 0;
 };
@@ -46,12 +60,39 @@ public:
                              std::string& message);
 };
 
+// AI 出牌策略：貪心規則，或是 ISMCTS（需要 attachState）
+enum class AiStrategy {
+    Greedy,
+    Ismcts
+};
+
 // Simple AI
-class Enemy : public Player {
+// 也是 AnytimeStrategy：think() 可以給期限（deadline）和取消旗標，
+// 開始搜尋前先放一個貪心規則的答案，所以任何時候 bestSoFar() 都有合法的一手。
+class Enemy : public Player, public AnytimeStrategy {
 public:
-    Enemy(const std::string& n) : Player(n), bombDecisionProb(1.0) {}
+    Enemy(const std::string& n);
 
+    // 沒有期限：只受 ISMCTS / 殘局搜尋自己的時間預算限制
     Move playTurn(const Move& lastMove) override;
+    // 在 limits 之內決定並出牌（從手牌移除）
+    Move playTurn(const Move& lastMove, const SearchLimits& limits);
+
+    // AnytimeStrategy：只決定，不動手牌
+    Move think(const Move& lastMove, const SearchLimits& limits) override;
+    Move bestSoFar() const override { return best.move(); }
+    // 這一手已經有答案了嗎（think() 還沒開始時沒有；出牌後清掉）
+    bool hasBestSoFar() const { return best.has(); }
+    // 別人的回合先替下一手想（只有 ISMCTS 會做：在對手要出牌的局面搜尋，
+    // 輪到自己時從對手實際出的那一手的子樹接著搜）；直到 limits 到期或被取消
+    void ponder(const SearchLimits& limits) override;
+    // 把 think() 的結果真的出掉（從手牌移除、印出），回傳同一手
+    Move playMove(const Move& mv);
+
+    // 每個 Enemy 有自己的亂數流（多執行緒模擬時互不干擾）
+    void seedRng(std::uint64_t seed) { rng.reseed(seed); }
+    // false: 不在 console 印出任何東西（模擬器用）
+    void setVerbose(bool v) { verbose = v; }
 
     // Game（例如 main_sfml）會根據「上一手出牌玩家的剩餘張數」
     // 來設定這個機率：0.0 ~ 1.0
@@ -61,23 +102,72 @@ public:
         bombDecisionProb = p;
     }
 
+    // 預設的機率公式：1 - 上一手出牌玩家剩餘張數 / 開局張數
+    // （只在桌上是普通牌型時 < 1，桌上是 Pass / 炸彈 / 火箭 時為 1）
+    static double bombDecisionProbFor(const GameState& state);
+
+    // 讓 AI 看得到整個牌局（engine）。殘局時（所有手牌合計 <= maxTotalCards）
+    // 會用完全資訊的 EndgameSolver 算出必勝手；沒有接上 engine 就只用貪心規則。
+    void attachState(const GameState* state) { table = state; }
+    // ISMCTS 抽樣對手手牌時參考的記牌器（已出的牌、底牌、Pass 推論）
+    void attachTracker(const CardTracker* t) { tracker = t; }
+    // maxTotalCards = 0 關掉殘局搜尋
+    void setEndgameSolver(int maxTotalCards, double budgetMs);
+    // 殘局搜尋和 ISMCTS 的殘局求解共用的置換表（可以多個 AI / 執行緒共用），null = 不用
+    void setTranspositionTable(TransTable* t);
+    // 殘局資料庫（Tablebase）：每家都剩 1..K 張時直接查表出必勝手，不搜尋；
+    // 殘局搜尋和 ISMCTS 的模擬也會查它。null = 不用
+    void attachTablebase(const Tablebase* tb);
+
+    // ISMCTS：抽樣對手手牌、模擬到終局、選拜訪次數最多的一手。
+    // 殘局搜尋有結果時仍以殘局搜尋為準。
+    void setStrategy(AiStrategy s) { strategy = s; }
+    AiStrategy getStrategy() const { return strategy; }
+    void setSearchOptions(const MctsOptions& o) { mcts.setOptions(o); }
+    // 每一手的思考時間（毫秒）
+    void setThinkTime(double ms);
+    // 上一次 ISMCTS 的 playouts / 延遲（用來決定各難度的時間預算）
+    const MctsStats& lastSearchStats() const { return mcts.stats(); }
+    // 上一次 ponder() 的 playouts / 時間
+    const MctsStats& lastPonderStats() const { return mcts.ponderStats(); }
+    // 上一手有沒有真的跑 ISMCTS（沒有的話 lastSearchStats 是更早那一手的）
+    bool searchedLastTurn() const { return searched; }
+    // 這一手的殘局搜尋結果（沒有搜尋時 nodes = 0）
+    const SolverResult& lastEndgameResult() const { return lastSolve; }
+
 private:
-    // 主要 AI 會用到的 helper
-    bool findSingleGreater(int targetRank, std::vector<int>& outIdx) const;
-    bool findPairGreater(int targetRank, std::vector<int>& outIdx) const;
-    bool findBomb(int targetRank, bool mustGreater, std::vector<int>& outIdx) const;
-    bool findRocket(std::vector<int>& outIdx) const;
-    bool findStraightGreater(int targetHighRank, int length, std::vector<int>& outIdx) const;
-    bool findFullHouseGreater(int targetTripleRank, std::vector<int>& outIdx) const;
-
-    // 開新一輪（桌上是 Pass）時專用：
-    // 先找「任意 5 張順子」、再找「任意葫蘆」、再找「低點數對子」。
-    bool findAnyStraight(int length, std::vector<int>& outIdx) const;
-    bool findAnyFullHouse(std::vector<int>& outIdx) const;
-    bool findOpeningPair(std::vector<int>& outIdx) const; // 避免 AA / 22 / JokerJoker
+    // 決定要出哪些牌（空集合 = Pass），不改動手牌；過程中的最佳解放在 best
+    CardSet chooseCards(const Move& lastMove, bool& savedBomb, const SearchLimits& limits);
+    // 貪心規則（不搜尋）
+    CardSet greedyCards(const Move& lastMove, bool& savedBomb);
+    // attached engine is at our turn with our hand and this table move
+    bool tableInSync(const Move& lastMove) const;
+
+    // 主要 AI 會用到的 helper（只看 handCounts，不配置記憶體）
+    // 找到時把要出的牌放進 out
+    bool findBomb(int targetRank, bool mustGreater, CardSet& out) const;
+    bool findRocket(CardSet& out) const;
+
+    // 用「最少出牌次數」拆牌（HandDecomposer）來決定：
+    // 開新一輪時出拆牌結果裡最小的一組（炸彈 / 火箭留到最後），
+    // 跟牌時選「出完之後剩下的牌最少次數出完」的同牌型。
+    CardSet planLead() const;
+    bool findPlanReply(const Move& lastMove, CardSet& out) const;
 
     // 炸彈 / 火箭 出不出的機率
     double bombDecisionProb;
+    Xoshiro256 rng;
+    bool verbose;
+
+    const GameState* table;     // live game state, may be null
+    const CardTracker* tracker; // may be null: uniform sampling
+    const Tablebase* tablebase; // may be null
+    EndgameSolver    endgame;
+    SolverResult     lastSolve;
+    AiStrategy       strategy;
+    IsmctsSearch     mcts;
+    BestMove         best;      // best move so far of the current decision
+    bool             searched;  // the current / last decision ran ISMCTS
 };
 
 #endif // CHARACTER_H
@@ -1,4 +1,5 @@
 #include "Deck.h"
+#include <algorithm>
 #include <random>
 #include <chrono>
 #include <stdexcept>
@@ -8,41 +9,106 @@ Deck::Deck() {
 }
 
 void Deck::init() {
-    cards.clear();
-
-    // Normal cards 3–2 (rank 3..15)
-    for (int r = 3; r <= 15; ++r) {
-        cards.emplace_back(Suit::Spade,   r);
-        cards.emplace_back(Suit::Heart,   r);
-        cards.emplace_back(Suit::Club,    r);
-        cards.emplace_back(Suit::Diamond, r);
+    // Normal cards 3–2 (rank 3..15), then small / big Joker
+    for (int id = 0; id < kCardCount; ++id) {
+        ids[id] = static_cast<CardId>(id);
     }
-
-    // Jokers
-    cards.emplace_back(Suit::Joker, 16); // small
-    cards.emplace_back(Suit::Joker, 17); // big
+    count = kCardCount;
 }
 
 void Deck::shuffle() {
     unsigned seed = static_cast<unsigned>(
         std::chrono::system_clock::now().time_since_epoch().count()
     );
-    std::shuffle(cards.begin(), cards.end(), std::default_random_engine(seed));
+    std::shuffle(ids, ids + count, std::default_random_engine(seed));
+}
+
+void Deck::shuffle(std::uint64_t seed) {
+    Xoshiro256 rng(seed);
+    for (std::size_t i = count; i > 1; --i) {
+        std::size_t j = rng.below(static_cast<std::uint32_t>(i));
+        std::swap(ids[i - 1], ids[j]);
+    }
 }
 
 bool Deck::empty() const {
-    return cards.empty();
+    return count == 0;
 }
 
 Card Deck::draw() {
-    if (cards.empty()) {
+    if (count == 0) {
         throw std::runtime_error("Deck is empty");
     }
-    Card c = cards.back();
-    cards.pop_back();
-    return c;
+    return Card::fromId(ids[--count]);
+}
+
+CardSet Deck::drawSet(std::size_t n) {
+    if (n > count) {
+        throw std::runtime_error("Deck has fewer cards than requested");
+    }
+    CardSet s;
+    for (std::size_t i = 0; i < n; ++i) {
+        s.add(ids[--count]);
+    }
+    return s;
+}
+
+CardSet Deck::remaining() const {
+    CardSet s;
+    for (std::size_t i = 0; i < count; ++i) {
+        s.add(ids[i]);
+    }
+    return s;
 }
 
 std::size_t Deck::size() const {
-    return cards.size();
+    return count;
+}
+
+// ======================
+// Dealing engine
+// ======================
+
+void dealCards(Xoshiro256& rng, Deal& out) {
+    CardId ids[kCardCount];
+    for (int i = 0; i < kCardCount; ++i) {
+        ids[i] = static_cast<CardId>(i);
+    }
+
+    // Fisher-Yates, written straight into the four sets
+    std::uint64_t sets[4] = { 0, 0, 0, 0 };
+    for (int i = kCardCount - 1; i >= 0; --i) {
+        int j = static_cast<int>(rng.below(static_cast<std::uint32_t>(i + 1)));
+        CardId id = ids[j];
+        ids[j] = ids[i];
+        // positions 53..37 -> seat 0, 36..20 -> seat 1, 19..3 -> seat 2, 2..0 -> bottom
+        int slot = i >= 3 ? (kCardCount - 1 - i) / kInitialHandSize : 3;
+        sets[slot] |= std::uint64_t{1} << id;
+    }
+
+    out.hands[0] = CardSet(sets[0]);
+    out.hands[1] = CardSet(sets[1]);
+    out.hands[2] = CardSet(sets[2]);
+    out.bottom   = CardSet(sets[3]);
+}
+
+Deal dealCards(std::uint64_t seed) {
+    Xoshiro256 rng(seed);
+    Deal d;
+    dealCards(rng, d);
+    return d;
+}
+
+void dealBatch(std::uint64_t seed, Deal* out, std::size_t count) {
+    Xoshiro256 rng(seed);
+    for (std::size_t i = 0; i < count; ++i) {
+        dealCards(rng, out[i]);
+    }
+}
+
+std::uint64_t randomDealSeed() {
+    std::uint64_t t = static_cast<std::uint64_t>(
+        std::chrono::system_clock::now().time_since_epoch().count()
+    );
+    return t ^ (static_cast<std::uint64_t>(std::random_device{}()) << 32);
 }
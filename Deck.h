@@ -1,21 +1,45 @@
 #ifndef DECK_H
 #define DECK_H
 
-#include <vector>
+#include <cstddef>
+#include <cstdint>
 #include "Card.h"
+#include "Rng.h"
+
+// One full deal: 17 cards for each of the three seats + 3 bottom cards
+struct Deal {
+    CardSet hands[3];
+    CardSet bottom;
+};
+
+constexpr int kInitialHandSize = 17;
+constexpr int kBottomCardCount = 3;
+
+// Reproducible dealing: the same seed always gives the same deal.
+Deal dealCards(std::uint64_t seed);
+void dealCards(Xoshiro256& rng, Deal& out);
+// Fill `out[0..count)` with consecutive deals from one seeded stream.
+void dealBatch(std::uint64_t seed, Deal* out, std::size_t count);
+
+// Seed from the clock, for interactive games that do not pass one in.
+std::uint64_t randomDealSeed();
 
 class Deck {
 private:
-    std::vector<Card> cards;
+    CardId      ids[kCardCount];
+    std::size_t count;
 
 public:
     Deck();
 
     void init();
     void shuffle();
+    void shuffle(std::uint64_t seed);
 
     bool empty() const;
     Card draw();
+    CardSet drawSet(std::size_t n); // draw `n` cards at once
+    CardSet remaining() const;
     std::size_t size() const;
 };
 
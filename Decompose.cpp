@@ -0,0 +1,165 @@
+#include "Decompose.h"
+
+#include <memory>
+
+namespace {
+
+// best first group, packed: type | rank << 8 | second rank << 16
+using GroupCode = std::uint32_t;
+
+GroupCode encode(HandType t, int rank, int second = 0) {
+    return static_cast<GroupCode>(t) |
+           static_cast<GroupCode>(rank) << 8 |
+           static_cast<GroupCode>(second) << 16;
+}
+
+// Cards of an encoded group. Straights keep their lowest rank in `rank`;
+// full houses keep the triple rank in `rank` and the pair rank in `second`.
+std::uint64_t patternOf(GroupCode g) {
+    HandType t = static_cast<HandType>(g & 0xFF);
+    int r  = static_cast<int>((g >> 8) & 0xFF);
+    int r2 = static_cast<int>((g >> 16) & 0xFF);
+    switch (t) {
+    case HandType::Single:    return RankCounts::bit(r);
+    case HandType::Pair:      return RankCounts::bit(r) * 2;
+    case HandType::Bomb:      return RankCounts::bit(r) * 4;
+    case HandType::FullHouse: return RankCounts::bit(r) * 3 + RankCounts::bit(r2) * 2;
+    case HandType::Rocket:    return RankCounts::bit(16) | RankCounts::bit(17);
+    case HandType::Straight: {
+        std::uint64_t p = 0;
+        for (int i = 0; i < 5; ++i) {
+            p |= RankCounts::bit(r + i);
+        }
+        return p;
+    }
+    default:
+        return 0;
+    }
+}
+
+PlanGroup toGroup(GroupCode g) {
+    HandType t = static_cast<HandType>(g & 0xFF);
+    int r = static_cast<int>((g >> 8) & 0xFF);
+    int mainRank = r;
+    if (t == HandType::Straight) mainRank = r + 4;   // straights rank by their top card
+    if (t == HandType::Rocket)   mainRank = 100;     // same as analyzeHand
+    return { t, mainRank, patternOf(g) };
+}
+
+// Direct-mapped memo, one per thread (the simulator and the parallel
+// search call in from many threads). A collision only costs a recompute.
+struct Memo {
+    static constexpr int kBits = 15;
+    static constexpr std::uint64_t kEmpty = ~std::uint64_t{0}; // nibbles > 4: never a hand
+
+    struct Entry {
+        std::uint64_t key;
+        GroupCode     group;
+        std::uint8_t  plays;
+    };
+
+    Entry entries[1 << kBits];
+    HandDecomposer::CacheStats stats;
+
+    Memo() {
+        for (auto& e : entries) {
+            e.key = kEmpty;
+        }
+    }
+
+    static std::size_t slot(std::uint64_t key) {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - kBits));
+    }
+};
+
+Memo& memo() {
+    thread_local std::unique_ptr<Memo> m;
+    if (!m) {
+        m.reset(new Memo());
+    }
+    return *m;
+}
+
+// minimum plays for histogram `w`; `best` receives the first group
+int solve(Memo& m, std::uint64_t w, GroupCode& best) {
+    if (w == 0) {
+        best = 0;
+        return 0;
+    }
+    Memo::Entry& e = m.entries[Memo::slot(w)];
+    if (e.key == w) {
+        ++m.stats.hits;
+        best = e.group;
+        return e.plays;
+    }
+    ++m.stats.misses;
+
+    RankCounts h(w);
+    int r = RankCounts::lowestRank(h.atLeast(1));
+    int c = h.count(r);
+
+    int bestPlays = 1 << 20;
+    GroupCode bestGroup = 0;
+    GroupCode unused;
+    auto tryGroup = [&](GroupCode g) {
+        int v = 1 + solve(m, w - patternOf(g), unused);
+        if (v < bestPlays) {
+            bestPlays = v;
+            bestGroup = g;
+        }
+    };
+
+    if (r == 16 && h.count(17) == 1) {
+        tryGroup(encode(HandType::Rocket, 17));
+    }
+    if (c == 4) {
+        tryGroup(encode(HandType::Bomb, r));
+    }
+    if (r <= 10 && (h.straightStarts(5) & RankCounts::bit(r))) {
+        tryGroup(encode(HandType::Straight, r));
+    }
+    if (c >= 3) {
+        for (std::uint64_t p = h.atLeast(2) & ~RankCounts::bit(r); p; p = RankCounts::dropLowest(p)) {
+            tryGroup(encode(HandType::FullHouse, r, RankCounts::lowestRank(p)));
+        }
+    }
+    if (c >= 2) {
+        for (std::uint64_t t = h.atLeast(3) & ~RankCounts::bit(r); t; t = RankCounts::dropLowest(t)) {
+            tryGroup(encode(HandType::FullHouse, RankCounts::lowestRank(t), r));
+        }
+        tryGroup(encode(HandType::Pair, r));
+    }
+    tryGroup(encode(HandType::Single, r));
+
+    // the recursion may have reused this slot: write it last
+    Memo::Entry& slot = m.entries[Memo::slot(w)];
+    slot.key   = w;
+    slot.group = bestGroup;
+    slot.plays = static_cast<std::uint8_t>(bestPlays);
+    best = bestGroup;
+    return bestPlays;
+}
+
+} // namespace
+
+int HandDecomposer::minPlays(RankCounts hand) {
+    GroupCode g;
+    return solve(memo(), hand.word(), g);
+}
+
+HandPlan HandDecomposer::plan(RankCounts hand) {
+    Memo& m = memo();
+    HandPlan p;
+    std::uint64_t w = hand.word();
+    while (w != 0) {
+        GroupCode g;
+        solve(m, w, g);
+        p.groups[p.plays++] = toGroup(g);
+        w -= patternOf(g);
+    }
+    return p;
+}
+
+HandDecomposer::CacheStats HandDecomposer::cacheStats() {
+    return memo().stats;
+}
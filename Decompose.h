@@ -0,0 +1,52 @@
+#ifndef DECOMPOSE_H
+#define DECOMPOSE_H
+
+#include <cstdint>
+#include "Card.h"
+#include "RankCounts.h"
+
+// =========================
+// Minimum-plays hand decomposition
+// =========================
+//
+// How many plays does a hand need to go out if nobody interferes? That is
+// the smallest split of its rank histogram into singles, pairs, 5-straights,
+// full houses, bombs and the rocket (a lone triple is not a hand here, so it
+// costs a pair + a single).
+//
+// DP over RankCounts: the lowest rank left must belong to some group, and
+// every group holding it either starts there (straight) or contains it
+// (single / pair / bomb / either half of a full house / rocket), so only
+// those groups are tried at each step. Results are memoized per thread in
+// a direct-mapped cache keyed by the histogram word; repeated queries
+// during a game cost one lookup.
+
+struct PlanGroup {
+    HandType      type;
+    int           mainRank;  // as analyzeHand reports it
+    std::uint64_t pattern;   // RankCounts word of the group's cards
+};
+
+struct HandPlan {
+    int       plays = 0;     // minimum number of plays to empty the hand
+    PlanGroup groups[20];    // `plays` groups, in the order the DP found them
+};
+
+class HandDecomposer {
+public:
+    struct CacheStats {
+        long long hits   = 0;
+        long long misses = 0;
+    };
+
+    // 0 for an empty hand
+    static int minPlays(RankCounts hand);
+
+    // one optimal decomposition of `hand`
+    static HandPlan plan(RankCounts hand);
+
+    // lookups of the calling thread's cache since it was created
+    static CacheStats cacheStats();
+};
+
+#endif // DECOMPOSE_H
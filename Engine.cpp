@@ -0,0 +1,213 @@
+#include "Engine.h"
+
+namespace {
+
+// ======================
+// Zobrist keys
+// ======================
+
+constexpr std::uint64_t splitmix64(std::uint64_t& x) {
+    x += 0x9E3779B97F4A7C15ull;
+    std::uint64_t z = x;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Fixed keys (same on every run / platform), built at compile time so no
+// static-initialization order can see them empty.
+//
+// Hands are keyed by how many cards of each rank a seat holds, not by card:
+// suits never matter, so the hash is the same for every suit assignment
+// (see Canonical.h) and one table entry serves all of them.
+constexpr int kHashRanks = 15; // 3..17
+
+struct ZobristKeys {
+    std::uint64_t count[3][kHashRanks][5]; // seat holds n cards of rank; n = 0 -> 0
+    std::uint64_t toMove[3];
+    std::uint64_t landlord[3];
+    std::uint64_t passCount[3];
+    std::uint64_t tableSalt;
+
+    constexpr ZobristKeys() : count(), toMove(), landlord(), passCount(), tableSalt() {
+        std::uint64_t x = 0x5DEECE66Dull;
+        for (auto& seat : count) {
+            for (auto& rank : seat) {
+                for (int n = 1; n < 5; ++n) rank[n] = splitmix64(x);
+            }
+        }
+        for (auto& k : toMove)    k = splitmix64(x);
+        for (auto& k : landlord)  k = splitmix64(x);
+        for (auto& k : passCount) k = splitmix64(x);
+        tableSalt = splitmix64(x);
+    }
+};
+
+constexpr ZobristKeys kZobrist;
+
+std::uint64_t handKey(int seat, CardSet cards) {
+    RankCounts rc = RankCounts::of(cards);
+    std::uint64_t h = 0;
+    for (std::uint64_t m = rc.atLeast(1); m; m = RankCounts::dropLowest(m)) {
+        int r = RankCounts::lowestRank(m);
+        h ^= kZobrist.count[seat][r - 3][rc.count(r)];
+    }
+    return h;
+}
+
+// `hand` of `seat` loses `played`: only the ranks played change key
+std::uint64_t playedKey(int seat, CardSet hand, CardSet played) {
+    RankCounts have = RankCounts::of(hand);
+    RankCounts out  = RankCounts::of(played);
+    std::uint64_t h = 0;
+    for (std::uint64_t m = out.atLeast(1); m; m = RankCounts::dropLowest(m)) {
+        int r = RankCounts::lowestRank(m);
+        int c = have.count(r);
+        h ^= kZobrist.count[seat][r - 3][c] ^ kZobrist.count[seat][r - 3][c - out.count(r)];
+    }
+    return h;
+}
+
+// the table move by pattern (its key), 0 for an empty table
+std::uint64_t tableKey(const Move& m) {
+    if (m.type == HandType::Pass) {
+        return 0;
+    }
+    std::uint64_t x = kZobrist.tableSalt ^ m.key;
+    return splitmix64(x);
+}
+
+} // namespace
+
+GameState::GameState()
+    : hands(),
+      tableMove(),
+      landlordIndex(-1),
+      currentPlayerIndex(0),
+      lastMovePlayerIndex(-1),
+      passCountInRound(0),
+      winnerIndex(-1),
+      turns(0),
+      zobrist(0)
+{
+    zobrist = computeHash();
+}
+
+void GameState::reset(const CardSet h[3], int landlord) {
+    for (int i = 0; i < 3; ++i) {
+        hands[i] = h[i];
+    }
+    tableMove           = Move();
+    landlordIndex       = landlord;
+    currentPlayerIndex  = landlord;
+    lastMovePlayerIndex = -1;
+    passCountInRound    = 0;
+    winnerIndex         = -1;
+    turns               = 0;
+    zobrist             = computeHash();
+}
+
+void GameState::start(const Deal& deal, int landlord) {
+    CardSet h[3] = { deal.hands[0], deal.hands[1], deal.hands[2] };
+    h[landlord] |= deal.bottom;
+    reset(h, landlord);
+}
+
+std::uint64_t GameState::computeHash() const {
+    std::uint64_t h = tableKey(tableMove) ^
+                      kZobrist.toMove[currentPlayerIndex] ^
+                      kZobrist.passCount[passCountInRound];
+    if (landlordIndex >= 0) {
+        h ^= kZobrist.landlord[landlordIndex];
+    }
+    for (int i = 0; i < 3; ++i) {
+        h ^= handKey(i, hands[i]);
+    }
+    return h;
+}
+
+void GameState::setHand(int seat, CardSet cards) {
+    zobrist ^= handKey(seat, hands[seat]) ^ handKey(seat, cards);
+    hands[seat] = cards;
+}
+
+int GameState::legalMoves(MoveList& out) const {
+    if (isTerminal()) {
+        out.clear();
+        return 0;
+    }
+    return MoveGenerator::generate(hands[currentPlayerIndex], tableMove, out);
+}
+
+bool GameState::isLegal(const Move& mv) const {
+    if (isTerminal()) {
+        return false;
+    }
+    if (mv.isPass()) {
+        return true;
+    }
+    if (!hands[currentPlayerIndex].containsAll(mv.cardSet)) {
+        return false;
+    }
+    auto info = analyzeHand(mv.cardSet);
+    if (info.first != mv.type || info.second != mv.mainRank) {
+        return false;
+    }
+    return canBeat(tableMove, mv);
+}
+
+UndoRecord GameState::apply(const Move& mv) {
+    int seat = currentPlayerIndex;
+    UndoRecord u{ tableMove, mv.cardSet, zobrist,
+                  static_cast<std::int8_t>(seat),
+                  static_cast<std::int8_t>(lastMovePlayerIndex),
+                  static_cast<std::int8_t>(passCountInRound),
+                  static_cast<std::int8_t>(winnerIndex) };
+    ++turns;
+    // out with the old table / pass count / mover, in with the new below
+    zobrist ^= tableKey(tableMove) ^
+               kZobrist.passCount[passCountInRound] ^
+               kZobrist.toMove[seat];
+
+    if (mv.isPass()) {
+        u.played = CardSet();
+        if (tableMove.type != HandType::Pass) {
+            passCountInRound++;
+            if (passCountInRound >= 2) {
+                // 兩人連續 Pass，清桌
+                tableMove           = Move();
+                lastMovePlayerIndex = -1;
+                passCountInRound    = 0;
+            }
+        }
+    } else {
+        zobrist            ^= playedKey(seat, hands[seat], mv.cardSet);
+        hands[seat]        -= mv.cardSet;
+        tableMove           = mv;
+        lastMovePlayerIndex = seat;
+        passCountInRound    = 0;
+
+        if (hands[seat].empty()) {
+            winnerIndex = seat; // the winner keeps the turn
+        }
+    }
+
+    if (winnerIndex < 0) {
+        currentPlayerIndex = nextSeat(seat);
+    }
+    zobrist ^= tableKey(tableMove) ^
+               kZobrist.passCount[passCountInRound] ^
+               kZobrist.toMove[currentPlayerIndex];
+    return u;
+}
+
+void GameState::undo(const UndoRecord& u) {
+    --turns;
+    currentPlayerIndex  = u.seat;
+    hands[u.seat]      |= u.played;
+    tableMove           = u.tableMove;
+    lastMovePlayerIndex = u.lastMovePlayer;
+    passCountInRound    = u.passCount;
+    winnerIndex         = u.winner;
+    zobrist             = u.hash;
+}
@@ -0,0 +1,103 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "Card.h"
+#include "Deck.h"
+#include "MoveGen.h"
+
+// =========================
+// Headless game engine
+// =========================
+//
+// The turn / pass / round-clear / winner rules in one place, with no I/O and
+// no allocation. The console Game and the SFML front end both drive it;
+// simulators and search run it directly.
+//
+// Seats are 0..2 and play in order 0 -> 1 -> 2 -> 0. The landlord leads the
+// first round. Two consecutive passes after a play clear the table; passing
+// on an empty table changes nothing but the turn. The first seat to empty
+// its hand wins (landlord alone vs the two peasants together).
+//
+// Every state carries a 64-bit Zobrist hash of what decides the rest of the
+// game: the three hands, the table move, the pass count, the player to move
+// and the landlord. apply() / undo() / setHand() keep it up to date with a
+// few XORs, so two move orders reaching the same position (a pair then a
+// single, or a single then a pair) get the same hash. Only suit-free facts
+// go in: each hand as its rank counts, the table move as its pattern key
+// (type, length, rank). States that differ only in suits therefore hash
+// alike (see Canonical.h). The turn count and the winner are not part of it.
+
+// Everything apply() changes besides the current seat, so undo() can put it
+// back without copying the whole state (48 bytes, trivially copyable).
+struct UndoRecord {
+    Move          tableMove;      // table move before the move
+    CardSet       played;         // cards taken out of the mover's hand
+    std::uint64_t hash;           // Zobrist hash before the move
+    std::int8_t   seat;           // who moved
+    std::int8_t   lastMovePlayer; // lastMovePlayerIndex before the move
+    std::int8_t   passCount;      // passCountInRound before the move
+    std::int8_t   winner;         // winnerIndex before the move
+};
+
+class GameState {
+public:
+    GameState();
+
+    // Start a game: `hands` already include the landlord's bottom cards.
+    void reset(const CardSet hands[3], int landlord);
+    // Start from a deal: the bottom cards go to `landlord`.
+    void start(const Deal& deal, int landlord);
+
+    CardSet hand(int seat) const { return hands[seat]; }
+    int handSize(int seat) const { return hands[seat].size(); }
+    int totalCards() const { return hands[0].size() + hands[1].size() + hands[2].size(); }
+
+    int landlord() const { return landlordIndex; }
+    int currentPlayer() const { return currentPlayerIndex; }
+    const Move& lastMove() const { return tableMove; }
+    int lastMovePlayer() const { return lastMovePlayerIndex; }
+    int passCount() const { return passCountInRound; }
+    int turnCount() const { return turns; }
+
+    bool isTerminal() const { return winnerIndex >= 0; }
+    int winner() const { return winnerIndex; } // -1 while the game runs
+    bool landlordWon() const { return winnerIndex == landlordIndex; }
+    bool sameTeam(int a, int b) const { return a == b || (a != landlordIndex && b != landlordIndex); }
+
+    static int nextSeat(int seat) { return seat == 2 ? 0 : seat + 1; }
+
+    // Replace one seat's cards without touching turn / table state
+    // (search uses it to try guesses of the hidden hands).
+    void setHand(int seat, CardSet cards);
+
+    // Zobrist hash of the position (see above); kept incrementally.
+    std::uint64_t hash() const { return zobrist; }
+    // The same hash computed from scratch (for checking the incremental one).
+    std::uint64_t computeHash() const;
+
+    // Every reply the current player may make (see MoveGenerator).
+    int legalMoves(MoveList& out) const;
+    // Is `mv` a valid hand, held by the current player and beating the table?
+    bool isLegal(const Move& mv) const;
+
+    // Play `mv` for the current player. The move is not re-validated:
+    // callers check it with isLegal() or take it from legalMoves().
+    // The returned record undoes exactly this move (make / unmake for search).
+    UndoRecord apply(const Move& mv);
+    void undo(const UndoRecord& u);
+
+private:
+    friend GameState canonicalState(const GameState& s); // Canonical.h: relabels suits
+
+    CardSet hands[3];
+    Move    tableMove;           // last non-cleared move (Pass if empty table)
+    int     landlordIndex;
+    int     currentPlayerIndex;
+    int     lastMovePlayerIndex;
+    int     passCountInRound;
+    int     winnerIndex;
+    int     turns;
+    std::uint64_t zobrist;
+};
+
+#endif // ENGINE_H
@@ -1,19 +1,19 @@
 #include "Game.h"
 
 #include <iostream>
-#include <chrono>
-#include <random>
+#include "Bidding.h"
 
 using namespace std;
 
 Game::Game()
-    : landlordIndex(-1),
-      currentPlayerIndex(0),
-      lastMove(),
-      lastMovePlayerIndex(-1),
-      passCountInRound(0)
+    : deal(),
+      state(),
+      tracker(),
+      table(16),
+      tablebase()
 {
     logFile.open("game_log.txt");
+    tablebase.open(Tablebase::kDefaultFile); // optional
     players.push_back(new Player("You"));
     players.push_back(new Enemy("AI_1"));
     players.push_back(new Enemy("AI_2"));
@@ -44,10 +44,6 @@ void Game::logWinner(const CardCharacter& player) {
     logFile << "===== Winner: " << player.getNameRef() << " =====\n";
 }
 
-int Game::nextPlayerIndex(int idx) const {
-    return (idx + 1) % 3;
-}
-
 int Game::decideLandlord() {
     char ans;
     cout << "[Landlord selection]\n";
@@ -59,12 +55,17 @@ int Game::decideLandlord() {
         cout << "You choose to be the landlord.\n";
         return 0;
     } else {
-        unsigned seed = static_cast<unsigned>(
-            chrono::system_clock::now().time_since_epoch().count()
-        );
-        default_random_engine eng(seed);
-        uniform_int_distribution<int> dist(1, 2);
-        int aiLandlord = dist(eng);
+        // each AI estimates its landlord win rate from its own 17 cards
+        // (~50 ms of rollouts in all); the more confident one takes it
+        const int seats[2] = { 1, 2 };
+        BidEstimate est[3];
+        int aiLandlord = BidEvaluator().pickLandlord(deal.hands, seats, 2,
+                                                     randomDealSeed(), est);
+        for (int seat : seats) {
+            cout << players[seat]->getNameRef() << " expects to win "
+                 << static_cast<int>(est[seat].winRate * 100.0 + 0.5)
+                 << "% as landlord (" << est[seat].rollouts << " rollouts)\n";
+        }
         cout << "You give up landlord. "
              << players[aiLandlord]->getNameRef()
              << " becomes the landlord.\n";
@@ -72,45 +73,47 @@ int Game::decideLandlord() {
     }
 }
 
-void Game::initGame() {
-    deck.init();
-    deck.shuffle();
-
-    for (int i = 0; i < 17; ++i) {
-        for (int p = 0; p < 3; ++p) {
-            players[p]->addCard(deck.draw());
-        }
+void Game::initGame(std::uint64_t seed) {
+    deal = dealCards(seed);
+    if (logFile.is_open()) {
+        logFile << "Deal seed: " << seed << "\n";
     }
 
-    vector<Card> bottomCards;
-    while (deck.size() > 0) {
-        bottomCards.push_back(deck.draw());
+    for (int p = 0; p < 3; ++p) {
+        players[p]->addCards(deal.hands[p]);
+        players[p]->sortHand();
     }
 
-    for (auto p : players) {
-        p->sortHand();
-    }
+    CardSet bottomCards = deal.bottom;
 
     cout << "\n=== Initial hand (console mode) ===\n";
     players[0]->printHand();
     cout << endl;
 
-    landlordIndex = decideLandlord();
+    int landlordIndex = decideLandlord();
 
     cout << ">>> Final landlord: [" << players[landlordIndex]->getNameRef()
          << "], extra cards: ";
-    for (const auto& c : bottomCards) {
-        cout << c << "  ";
-        players[landlordIndex]->addCard(c);
+    for (CardId id : bottomCards) {
+        cout << Card::fromId(id) << "  ";
     }
     cout << "\n";
+    players[landlordIndex]->addCards(bottomCards);
 
     players[landlordIndex]->sortHand();
 
-    currentPlayerIndex  = landlordIndex;
-    lastMove            = Move();
-    lastMovePlayerIndex = -1;
-    passCountInRound    = 0;
+    state.start(deal, landlordIndex);
+    tracker.start(deal.bottom, landlordIndex);
+
+    // AI 殘局時直接看整個 engine 做精確搜尋
+    for (int p = 1; p < 3; ++p) {
+        if (Enemy* e = dynamic_cast<Enemy*>(players[p])) {
+            e->attachState(&state);
+            e->attachTracker(&tracker);
+            e->setTranspositionTable(&table);
+            e->attachTablebase(tablebase.loaded() ? &tablebase : nullptr);
+        }
+    }
 }
 
 void Game::play() {
@@ -137,42 +140,27 @@ void Game::play() {
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
     cout << "\n===== Game Start (console mode) =====\n\n";
 
-    bool gameOver = false;
-
-    while (!gameOver) {
+    while (!state.isTerminal()) {
+        int current = state.currentPlayer();
         cout << "\n----------------------------------------\n";
-        cout << "Now it is [" << players[currentPlayerIndex]->getNameRef()
+        cout << "Now it is [" << players[current]->getNameRef()
              << "]'s turn.\n";
 
-        Move currentMove = players[currentPlayerIndex]->playTurn(lastMove);
-        logMove(*players[currentPlayerIndex], currentMove);
-
-        if (currentMove.isPass()) {
-            if (lastMove.type != HandType::Pass) {
-                passCountInRound++;
-                if (passCountInRound >= 2) {
-                    cout << "Two consecutive Pass. Round cleared.\n";
-                    lastMove            = Move();
-                    lastMovePlayerIndex = -1;
-                    passCountInRound    = 0;
-                }
-            }
-        } else {
-            lastMove            = currentMove;
-            lastMovePlayerIndex = currentPlayerIndex;
-            passCountInRound    = 0;
-        }
+        Move currentMove = players[current]->playTurn(state.lastMove());
+        logMove(*players[current], currentMove);
 
-        if (players[currentPlayerIndex]->isHandEmpty()) {
-            cout << "\n============================\n";
-            cout << "Game over! Winner: ["
-                 << players[currentPlayerIndex]->getNameRef() << "]\n";
-            cout << "============================\n";
-            logWinner(*players[currentPlayerIndex]);
-            gameOver = true;
-            break;
+        bool tableWasSet = !state.lastMove().isPass();
+        tracker.observe(state, currentMove);
+        state.apply(currentMove);
+        if (currentMove.isPass() && tableWasSet && state.lastMove().isPass()) {
+            cout << "Two consecutive Pass. Round cleared.\n";
         }
-
-        currentPlayerIndex = nextPlayerIndex(currentPlayerIndex);
     }
+
+    int winner = state.winner();
+    cout << "\n============================\n";
+    cout << "Game over! Winner: ["
+         << players[winner]->getNameRef() << "]\n";
+    cout << "============================\n";
+    logWinner(*players[winner]);
 }
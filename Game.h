@@ -3,27 +3,30 @@
 
 #include <vector>
 #include <fstream>
+#include <cstdint>
+#include "CardTracker.h"
 #include "Deck.h"
 #include "Character.h"
+#include "Engine.h"
+#include "Tablebase.h"
+#include "TransTable.h"
 
 class Game {
 private:
-    Deck deck;
     std::vector<CardCharacter*> players;
     std::ofstream logFile;
 
-    int landlordIndex;
-    int currentPlayerIndex;
-
-    Move lastMove;
-    int lastMovePlayerIndex;
-    int passCountInRound;
+    Deal deal;
+    GameState state; // rules: turn order, passes, round clear, winner
+    CardTracker tracker; // what has been played / passed, for the AIs
+    TransTable table;    // solved endgames, shared by both AIs
+    Tablebase tablebase; // doudizhu.tb if present (built by doudizhu_tablebase)
 
 public:
     Game();
     ~Game();
 
-    void initGame();
+    void initGame(std::uint64_t seed);
     void play();
 
 private:
@@ -31,7 +34,6 @@ private:
     void logWinner(const CardCharacter& player);
 
     int decideLandlord();
-    int nextPlayerIndex(int idx) const;
 };
 
 #endif // GAME_H
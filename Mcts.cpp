@@ -0,0 +1,749 @@
+#include "Mcts.h"
+
+#include <cmath>
+#include <new>
+#include <stdexcept>
+#include "Scheduler.h"
+
+namespace {
+
+// The move a slot stands for, with suits taken from `hand`
+Move slotMove(std::uint16_t info, std::uint64_t pattern, CardSet hand) {
+    return Move(static_cast<HandType>(info >> 8), takeCounts(hand, RankCounts(pattern)),
+                static_cast<std::int8_t>(info & 0xFF));
+}
+
+std::uint16_t slotInfo(const Move& mv) {
+    return static_cast<std::uint16_t>(static_cast<unsigned>(mv.type) << 8 |
+                                      (static_cast<unsigned>(mv.mainRank) & 0xFFu));
+}
+
+// Children block sizes. Most nodes are reached only a few times, so the
+// first block holds two children; each overflow block doubles, up to the
+// moves the mover has in this deal.
+constexpr int kFirstBlock = 2;
+
+int nextBlockCapacity(int legal, int previous) {
+    int c = 2 * previous;
+    if (c > legal) c = legal;
+    return c < kFirstBlock ? kFirstBlock : c;
+}
+
+// a seat of the winning team, given whether the player to move's team wins
+int winningSeat(const GameState& s, bool moverWins) {
+    int me = s.currentPlayer();
+    if (moverWins) {
+        return me;
+    }
+    return me == s.landlord() ? GameState::nextSeat(me) : s.landlord();
+}
+
+} // namespace
+
+// ======================
+// Tree (node storage)
+// ======================
+
+IsmctsSearch::Tree::Tree()
+    : owned(), used(0), rootKids(kNone), nodeCount(0), growMutex()
+{
+    for (auto& s : slabs) {
+        s.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+void IsmctsSearch::Tree::clear() {
+    used.store(0, std::memory_order_relaxed);
+    rootKids.store(kNone, std::memory_order_relaxed);
+    nodeCount = 0;
+}
+
+std::uint32_t IsmctsSearch::Tree::newBlock(int capacity, int mover) {
+    // header, then 8-byte patterns, four 4-byte arrays and 2-byte infos,
+    // rounded so the next block's header stays 8-byte aligned
+    const std::size_t size = (sizeof(Block) + static_cast<std::size_t>(capacity) * 26 + 7) &
+                             ~static_cast<std::size_t>(7);
+    const std::size_t limit = static_cast<std::size_t>(kMaxSlabs) * kSlabBytes;
+
+    // bump allocate; a block that would straddle two slabs starts the next one
+    std::size_t start = used.load(std::memory_order_relaxed);
+    std::size_t end;
+    do {
+        std::size_t at = start;
+        if ((at & (kSlabBytes - 1)) + size > kSlabBytes) {
+            at = (at | (kSlabBytes - 1)) + 1;
+        }
+        end = at + size;
+        if (end > limit) {
+            return kNone;
+        }
+        if (used.compare_exchange_weak(start, end, std::memory_order_relaxed)) {
+            start = at;
+            break;
+        }
+    } while (true);
+
+    int slab = static_cast<int>(start >> kSlabBits);
+    unsigned char* base = slabs[slab].load(std::memory_order_acquire);
+    if (!base) {
+        std::lock_guard<std::mutex> lock(growMutex);
+        base = slabs[slab].load(std::memory_order_relaxed);
+        if (!base) {
+            owned.emplace_back(new unsigned char[kSlabBytes]);
+            base = owned.back().get();
+            slabs[slab].store(base, std::memory_order_release);
+        }
+    }
+
+    const std::uint32_t ref = static_cast<std::uint32_t>(start);
+    Block* b = new (base + (start & (kSlabBytes - 1))) Block;
+    b->count.store(0, std::memory_order_relaxed);
+    b->next.store(kNone, std::memory_order_relaxed);
+    b->capacity = static_cast<std::uint16_t>(capacity);
+    b->mover    = static_cast<std::int8_t>(mover);
+    Children ch = children(ref);
+    for (int i = 0; i < capacity; ++i) {
+        new (&ch.pattern[i]) std::atomic<std::uint64_t>(kEmpty);
+        new (&ch.visits[i]) std::atomic<std::uint32_t>(0);
+        new (&ch.avail[i]) std::atomic<std::uint32_t>(0);
+        new (&ch.wins[i]) std::atomic<std::uint32_t>(0);
+        new (&ch.kids[i]) std::atomic<std::uint32_t>(kNone);
+    }
+    return ref;
+}
+
+IsmctsSearch::Tree::Children IsmctsSearch::Tree::children(std::uint32_t block) {
+    unsigned char* p = slabs[block >> kSlabBits].load(std::memory_order_relaxed) +
+                       (block & (kSlabBytes - 1));
+    Children ch;
+    ch.head = reinterpret_cast<Block*>(p);
+    const std::size_t cap = ch.head->capacity;
+    p += sizeof(Block);
+    ch.pattern = reinterpret_cast<std::atomic<std::uint64_t>*>(p);
+    p += cap * sizeof(std::uint64_t);
+    ch.visits = reinterpret_cast<std::atomic<std::uint32_t>*>(p);
+    ch.avail  = ch.visits + cap;
+    ch.wins   = ch.avail + cap;
+    ch.kids   = ch.wins + cap;
+    ch.info   = reinterpret_cast<std::uint16_t*>(ch.kids + cap);
+    return ch;
+}
+
+// ======================
+// IsmctsSearch
+// ======================
+
+IsmctsSearch::IsmctsSearch(const MctsOptions& o)
+    : opts(), lastStats(), lastPonderStats(), trees(), workers(), claimed(0), rootMoves(), sampler(),
+      lastRoot(), haveLastRoot(false), lastObserver(-1), lastPondered(false),
+      observer(0), limits(nullptr), timed(false), deadline(), progress(nullptr)
+{
+    setOptions(o);
+}
+
+IsmctsSearch::~IsmctsSearch() = default;
+
+IsmctsSearch::IsmctsSearch(IsmctsSearch&& o) noexcept
+    : opts(o.opts),
+      lastStats(o.lastStats),
+      lastPonderStats(o.lastPonderStats),
+      trees(std::move(o.trees)),
+      workers(std::move(o.workers)),
+      claimed(0),
+      rootMoves(),
+      sampler(o.sampler),
+      lastRoot(o.lastRoot),
+      haveLastRoot(o.haveLastRoot),
+      lastObserver(o.lastObserver),
+      lastPondered(o.lastPondered),
+      observer(0),
+      limits(nullptr),
+      timed(false),
+      deadline(),
+      progress(nullptr) {}
+
+IsmctsSearch& IsmctsSearch::operator=(IsmctsSearch&& o) noexcept {
+    opts      = o.opts;
+    lastStats = o.lastStats;
+    lastPonderStats = o.lastPonderStats;
+    trees     = std::move(o.trees);
+    workers   = std::move(o.workers);
+    sampler   = o.sampler;
+    lastRoot  = o.lastRoot;
+    haveLastRoot = o.haveLastRoot;
+    lastObserver = o.lastObserver;
+    lastPondered = o.lastPondered;
+    return *this;
+}
+
+void IsmctsSearch::setOptions(const MctsOptions& o) {
+    if (o.budgetMs <= 0.0 && o.maxPlayouts <= 0) {
+        throw std::invalid_argument("MctsOptions: need a time or playout budget");
+    }
+    if (o.threads < 1 || o.virtualLoss < 1) {
+        throw std::invalid_argument("MctsOptions: threads and virtualLoss must be >= 1");
+    }
+    if (o.solveCards < 0) {
+        throw std::invalid_argument("MctsOptions: solveCards must be >= 0");
+    }
+    if (o.threads != opts.threads || o.parallel != opts.parallel) {
+        haveLastRoot = false; // the trees no longer line up with the threads
+    }
+    opts = o;
+}
+
+// Deal the cards the observer cannot see: everything in the other two
+// hands, keeping each hand's size.
+void IsmctsSearch::determinize(GameState& s, Xoshiro256& rng) const {
+    if (sampler.ready()) {
+        sampler.sample(s, rng);
+        return;
+    }
+    int a = GameState::nextSeat(observer);
+    int b = GameState::nextSeat(a);
+
+    CardSet unseen = s.hand(a) | s.hand(b);
+    CardId pool[kCardCount];
+    int n = 0;
+    for (CardId id : unseen) {
+        pool[n++] = id;
+    }
+
+    // partial Fisher-Yates: the first handSize(a) picks go to a
+    int na = s.handSize(a);
+    CardSet handA;
+    for (int i = 0; i < na; ++i) {
+        int j = i + static_cast<int>(rng.below(static_cast<std::uint32_t>(n - i)));
+        CardId t = pool[i];
+        pool[i] = pool[j];
+        pool[j] = t;
+        handA.add(pool[i]);
+    }
+    s.setHand(a, handA);
+    s.setHand(b, unseen - handA);
+}
+
+// Claim a slot for `mv` in the children of the node whose children block
+// is `kids` (creating the block if needed) and count this thread's visit
+// in it. If another thread added the same pattern first, that slot is used
+// instead. Returns a slot with block kNone when the arena is full.
+IsmctsSearch::Tree::Slot IsmctsSearch::addChild(Tree& tree, std::atomic<std::uint32_t>& kids,
+                                                const Move& mv, int mover, int legal) {
+    const std::uint64_t pattern = RankCounts::of(mv.cardSet).word();
+    const std::uint32_t vl = static_cast<std::uint32_t>(opts.virtualLoss);
+    Tree::Slot out;
+
+    std::uint32_t b = kids.load(std::memory_order_acquire);
+    if (b == Tree::kNone) {
+        std::uint32_t nb = tree.newBlock(kFirstBlock, mover);
+        if (nb == Tree::kNone) {
+            return out;
+        }
+        // on a lost race the new block is left unused and `b` is the winner's
+        if (kids.compare_exchange_strong(b, nb, std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+            b = nb;
+        }
+    }
+
+    for (;;) {
+        Tree::Children ch = tree.children(b);
+        const int cap = ch.head->capacity;
+        const int seen = ch.size();
+        for (int i = 0; i < seen; ++i) {
+            if (ch.pattern[i].load(std::memory_order_acquire) == pattern) {
+                ch.visits[i].fetch_add(vl, std::memory_order_relaxed);
+                out.block = b;
+                out.index = i;
+                return out;
+            }
+        }
+        if (seen < cap) {
+            int i = static_cast<int>(ch.head->count.fetch_add(1, std::memory_order_acq_rel));
+            if (i < cap) {
+                ch.visits[i].store(vl, std::memory_order_relaxed);
+                ch.avail[i].store(1, std::memory_order_relaxed);
+                ch.wins[i].store(0, std::memory_order_relaxed);
+                ch.kids[i].store(Tree::kNone, std::memory_order_relaxed);
+                ch.info[i] = slotInfo(mv);
+                ch.pattern[i].store(pattern, std::memory_order_seq_cst);
+                out.block = b;
+                out.index = i;
+                // Another thread may be publishing the same pattern, in this
+                // block or, having missed its last slot, in the overflow
+                // block. Both store before scanning the whole chain, so at
+                // least one sees the other, and whoever does kills the copy
+                // that comes later in the chain.
+                bool passed = false; // our own slot is behind us
+                for (std::uint32_t c = kids.load(std::memory_order_acquire); c != Tree::kNone; ) {
+                    Tree::Children cc = tree.children(c);
+                    for (int k = 0, size = cc.size(); k < size; ++k) {
+                        if (c == b && k == i) {
+                            passed = true;
+                            continue;
+                        }
+                        if (cc.pattern[k].load(std::memory_order_seq_cst) != pattern) {
+                            continue;
+                        }
+                        if (!passed) {
+                            // an earlier copy: ours goes, the visit moves there
+                            ch.pattern[i].store(Tree::kDead, std::memory_order_relaxed);
+                            cc.visits[k].fetch_add(vl, std::memory_order_relaxed);
+                            out.block = c;
+                            out.index = k;
+                            return out;
+                        }
+                        std::uint64_t later = pattern;
+                        cc.pattern[k].compare_exchange_strong(later, Tree::kDead,
+                                                              std::memory_order_relaxed);
+                    }
+                    c = cc.head->next.load(std::memory_order_acquire);
+                }
+                return out;
+            }
+        }
+        // block full: continue in its overflow block
+        std::uint32_t nx = ch.head->next.load(std::memory_order_acquire);
+        if (nx == Tree::kNone) {
+            std::uint32_t nb = tree.newBlock(nextBlockCapacity(legal, cap), mover);
+            if (nb == Tree::kNone) {
+                return out;
+            }
+            if (ch.head->next.compare_exchange_strong(nx, nb, std::memory_order_acq_rel,
+                                                      std::memory_order_acquire)) {
+                nx = nb;
+            }
+        }
+        b = nx;
+    }
+}
+
+// Random playout. A hand that is itself one legal move is always played
+// out: a uniform choice misses most of those wins. Small endgames are
+// solved instead (no time budget, so the result does not depend on timing
+// or on what the shared table holds); only the search limits can cut a
+// solve short, and then the playout goes on at random.
+int IsmctsSearch::playout(Worker& w) {
+    GameState& s = w.state;
+    bool solve = opts.solveCards > 0;
+    while (!s.isTerminal()) {
+        if (opts.tablebase && opts.tablebase->covers(s)) {
+            ++w.tbHits;
+            return winningSeat(s, opts.tablebase->win(s));
+        }
+        if (solve && s.totalCards() <= opts.solveCards) {
+            SolverResult r = w.solver.solve(s, *limits);
+            w.solverNodes += r.nodes;
+            w.ttHits      += r.ttHits;
+            if (r.solved) {
+                ++w.solved;
+                return winningSeat(s, r.win);
+            }
+            solve = false; // out of time: finish this one at random
+        }
+        int n = s.legalMoves(w.moves);
+        CardSet hand = s.hand(s.currentPlayer());
+        const Move* pick = &w.moves[static_cast<int>(w.rng.below(static_cast<std::uint32_t>(n)))];
+        for (const Move& mv : w.moves) {
+            if (mv.cardSet == hand) {
+                pick = &mv;
+                break;
+            }
+        }
+        s.apply(*pick);
+    }
+    return s.winner();
+}
+
+// One determinized iteration: select / expand / playout / backpropagate.
+// Visits are added on the way down (virtual loss) and wins on the way up.
+void IsmctsSearch::iterate(Tree& tree, Worker& w) {
+    GameState& s = w.state;
+    const std::uint32_t vl = static_cast<std::uint32_t>(opts.virtualLoss);
+    std::atomic<std::uint32_t>* kids = &tree.root();
+    int depth = 0;
+
+    while (!s.isTerminal() && depth < kMaxPath) {
+        int seat = s.currentPlayer();
+        CardSet hand = s.hand(seat);
+        RankCounts have = RankCounts::of(hand);
+        int legal = s.legalMoves(w.moves);
+
+        // children this deal can play: bump availability, keep the best UCB
+        std::uint64_t seen[kMaxGenMoves];
+        int available = 0;
+        Tree::Slot best;
+        double bestScore = -1.0;
+        for (std::uint32_t b = kids->load(std::memory_order_acquire); b != Tree::kNone; ) {
+            Tree::Children ch = tree.children(b);
+            for (int i = 0, size = ch.size(); i < size; ++i) {
+                std::uint64_t p = ch.pattern[i].load(std::memory_order_acquire);
+                if (p == Tree::kEmpty || p == Tree::kDead ||
+                    !have.covers(RankCounts(p)) || available == legal) {
+                    continue;
+                }
+                seen[available++] = p;
+                double av = static_cast<double>(ch.avail[i].fetch_add(1, std::memory_order_relaxed) + 1);
+                double n  = static_cast<double>(ch.visits[i].load(std::memory_order_relaxed));
+                double wv = static_cast<double>(ch.wins[i].load(std::memory_order_relaxed));
+                double score = wv / n + opts.exploration * std::sqrt(std::log(av) / n);
+                if (score > bestScore) {
+                    bestScore = score;
+                    best.block = b;
+                    best.index = i;
+                }
+            }
+            b = ch.head->next.load(std::memory_order_acquire);
+        }
+
+        if (available < legal) {
+            // expand: a random move no child covers yet
+            int untried[kMaxGenMoves];
+            int nu = 0;
+            for (int i = 0; i < legal; ++i) {
+                std::uint64_t p = RankCounts::of(w.moves[i].cardSet).word();
+                bool found = false;
+                for (int k = 0; k < available && !found; ++k) {
+                    found = (seen[k] == p);
+                }
+                if (!found) {
+                    untried[nu++] = i;
+                }
+            }
+            Move mv = w.moves[untried[w.rng.below(static_cast<std::uint32_t>(nu))]];
+            Tree::Slot child = addChild(tree, *kids, mv, seat, legal);
+            if (child.block != Tree::kNone) {
+                Tree::Children ch = tree.children(child.block);
+                s.apply(slotMove(ch.info[child.index],
+                                 ch.pattern[child.index].load(std::memory_order_relaxed), hand));
+                w.path[depth++] = child;
+                ++w.nodes;
+            }
+            break; // tree full: play out from here
+        }
+
+        Tree::Children ch = tree.children(best.block);
+        ch.visits[best.index].fetch_add(vl, std::memory_order_relaxed);
+        s.apply(slotMove(ch.info[best.index],
+                         ch.pattern[best.index].load(std::memory_order_relaxed), hand));
+        w.path[depth++] = best;
+        kids = &ch.kids[best.index];
+    }
+
+    int winner = s.isTerminal() ? s.winner() : playout(w);
+
+    while (depth > 0) {
+        const Tree::Slot& sl = w.path[--depth];
+        Tree::Children ch = tree.children(sl.block);
+        if (vl > 1) {
+            ch.visits[sl.index].fetch_sub(vl - 1, std::memory_order_relaxed);
+        }
+        if (s.sameTeam(ch.head->mover, winner)) {
+            ch.wins[sl.index].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool IsmctsSearch::followsLastRoot(const GameState& s, int me, std::uint64_t steps[3],
+                                   int& count) const {
+    count = s.turnCount() - lastRoot.turnCount();
+    if (!haveLastRoot || me != lastObserver || s.landlord() != lastRoot.landlord() ||
+        count < 0 || count > 3) {
+        return false;
+    }
+    // one move per seat, so each seat's missing cards are its move; the
+    // seats that have not moved yet must hold what they held
+    int seat = lastRoot.currentPlayer();
+    for (int k = 0; k < 3; ++k) {
+        CardSet before = lastRoot.hand(seat);
+        CardSet after  = s.hand(seat);
+        if (k < count ? !before.containsAll(after) : before != after) {
+            return false;
+        }
+        if (k < count) {
+            steps[k] = RankCounts::of(before - after).word();
+        }
+        seat = GameState::nextSeat(seat);
+    }
+    return true;
+}
+
+bool IsmctsSearch::reroot(Tree& tree, const std::uint64_t steps[3], int count) {
+    std::atomic<std::uint32_t>* kids = &tree.root();
+    for (int k = 0; k < count; ++k) {
+        std::atomic<std::uint32_t>* next = nullptr;
+        for (std::uint32_t b = kids->load(std::memory_order_relaxed); b != Tree::kNone && !next; ) {
+            Tree::Children ch = tree.children(b);
+            for (int i = 0, n = ch.size(); i < n; ++i) {
+                if (ch.pattern[i].load(std::memory_order_relaxed) == steps[k]) {
+                    next = &ch.kids[i];
+                    break;
+                }
+            }
+            b = ch.head->next.load(std::memory_order_relaxed);
+        }
+        if (!next) {
+            return false;
+        }
+        kids = next;
+    }
+
+    std::uint32_t newRoot = kids->load(std::memory_order_relaxed);
+    for (std::uint32_t b = newRoot; b != Tree::kNone; ) {
+        Tree::Children ch = tree.children(b);
+        for (int i = 0, n = ch.size(); i < n; ++i) {
+            if (ch.pattern[i].load(std::memory_order_relaxed) < Tree::kDead) {
+                lastStats.reusedVisits += ch.visits[i].load(std::memory_order_relaxed);
+                lastStats.reusedNodes  += 1 + countNodes(tree, ch.kids[i].load(std::memory_order_relaxed));
+            }
+        }
+        b = ch.head->next.load(std::memory_order_relaxed);
+    }
+    tree.root().store(newRoot, std::memory_order_relaxed);
+    return true;
+}
+
+long long IsmctsSearch::countNodes(Tree& tree, std::uint32_t block) {
+    long long n = 0;
+    for (std::uint32_t b = block; b != Tree::kNone; ) {
+        Tree::Children ch = tree.children(b);
+        for (int i = 0, size = ch.size(); i < size; ++i) {
+            if (ch.pattern[i].load(std::memory_order_relaxed) < Tree::kDead) {
+                n += 1 + countNodes(tree, ch.kids[i].load(std::memory_order_relaxed));
+            }
+        }
+        b = ch.head->next.load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+int IsmctsSearch::RootTally::best() const {
+    int b = count > 0 ? 0 : -1;
+    for (int k = 1; k < count; ++k) {
+        if (visits[k] > visits[b]) {
+            b = k;
+        }
+    }
+    return b;
+}
+
+// The root player's own moves are always available, so visits compare fairly.
+void IsmctsSearch::tallyRoot(Tree& tree, RootTally& t) {
+    for (std::uint32_t b = tree.root().load(std::memory_order_acquire); b != Tree::kNone; ) {
+        Tree::Children ch = tree.children(b);
+        for (int i = 0, n = ch.size(); i < n; ++i) {
+            std::uint64_t p = ch.pattern[i].load(std::memory_order_acquire);
+            if (p == Tree::kEmpty || p == Tree::kDead) {
+                continue;
+            }
+            int k = 0;
+            while (k < t.count && t.patterns[k] != p) {
+                ++k;
+            }
+            if (k == t.count) {
+                if (t.count == kMaxGenMoves) {
+                    continue;
+                }
+                t.patterns[k] = p;
+                t.visits[k]   = 0;
+                t.info[k]     = ch.info[i];
+                ++t.count;
+            }
+            t.visits[k] += ch.visits[i].load(std::memory_order_relaxed);
+        }
+        b = ch.head->next.load(std::memory_order_acquire);
+    }
+}
+
+void IsmctsSearch::runWorker(int index, int treeCount, const GameState& root) {
+    Worker& w = workers[static_cast<std::size_t>(index)];
+    Tree& tree = *trees[static_cast<std::size_t>(treeCount == 1 ? 0 : index)];
+    const bool shared = (treeCount == 1);
+    const CardSet hand = root.hand(root.currentPlayer());
+
+    // Root mode: a fixed share of the playout budget per tree
+    long long quota = 0;
+    if (!shared && opts.maxPlayouts > 0) {
+        int threads = static_cast<int>(workers.size());
+        quota = opts.maxPlayouts / threads + (index < opts.maxPlayouts % threads ? 1 : 0);
+        if (quota == 0) {
+            return;
+        }
+    }
+
+    for (;;) {
+        if (shared && opts.maxPlayouts > 0 &&
+            claimed.fetch_add(1, std::memory_order_relaxed) >= opts.maxPlayouts) {
+            break;
+        }
+        w.state = root;
+        determinize(w.state, w.rng);
+        iterate(tree, w);
+        ++w.playouts;
+
+        if (progress && index == 0 && (w.playouts & 63) == 0) {
+            RootTally t;
+            tallyRoot(tree, t);
+            int b = t.best();
+            if (b >= 0) {
+                progress->publish(slotMove(t.info[b], t.patterns[b], hand).cardSet);
+            }
+        }
+        if (quota > 0 && w.playouts >= quota) {
+            break;
+        }
+        // the clock costs more than a short playout: look every 8
+        if ((w.playouts & 7) == 0 &&
+            (limits->stop.stopRequested() ||
+             (timed && std::chrono::steady_clock::now() >= deadline))) {
+            break;
+        }
+    }
+}
+
+Move IsmctsSearch::choose(const GameState& state, Xoshiro256& rng,
+                          const CardTracker* tracker, const SearchLimits& lim,
+                          BestMove* prog) {
+    if (state.isTerminal()) {
+        throw std::logic_error("IsmctsSearch::choose: the game is over");
+    }
+    auto start = std::chrono::steady_clock::now();
+    lastStats = MctsStats();
+
+    state.legalMoves(rootMoves);
+    if (rootMoves.size() == 1) {
+        lastPondered = false; // a ponder before a forced move has nothing to hit
+        lastStats.ms = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - start).count();
+        return rootMoves[0];
+    }
+
+    RootTally tally;
+    search(state, state.currentPlayer(), false, rng, tracker, lim, prog, start, tally);
+    int best = tally.best();
+    if (best < 0) {
+        return rootMoves[0];
+    }
+    return slotMove(tally.info[best], tally.patterns[best], state.hand(state.currentPlayer()));
+}
+
+void IsmctsSearch::ponder(const GameState& state, int me, Xoshiro256& rng,
+                          const CardTracker* tracker, const SearchLimits& lim) {
+    if (state.isTerminal() || !opts.reuseTree) {
+        return; // nothing a later decision could keep
+    }
+    // the ponder's numbers go to ponderStats(); stats() keeps the last choose()
+    MctsStats kept = lastStats;
+    auto start = std::chrono::steady_clock::now();
+    lastStats = MctsStats();
+    RootTally tally;
+    search(state, me, true, rng, tracker, lim, nullptr, start, tally);
+    lastPonderStats = lastStats;
+    lastStats = kept;
+}
+
+void IsmctsSearch::search(const GameState& state, int me, bool pondering, Xoshiro256& rng,
+                          const CardTracker* tracker, const SearchLimits& lim,
+                          BestMove* prog, std::chrono::steady_clock::time_point start,
+                          RootTally& tally) {
+    // a ponder runs to the caller's deadline, not the per-move budget
+    const double budget = (pondering && lim.hasDeadline()) ? 0.0 : opts.budgetMs;
+    limits   = &lim;
+    timed    = budget > 0.0 || lim.hasDeadline();
+    deadline = lim.capped(start, budget);
+    progress = prog;
+    observer = me;
+
+    // a tracker out of step with the state is ignored (uniform deals)
+    sampler = HandSampler();
+    if (tracker) {
+        sampler.prepare(*tracker, state, me);
+    }
+
+    const int threads   = opts.threads;
+    const int treeCount = (opts.parallel == MctsParallel::Root) ? threads : 1;
+    while (static_cast<int>(trees.size()) < treeCount) {
+        trees.push_back(std::make_unique<Tree>());
+    }
+    // keep the last search's trees when this position is at most a round
+    // later and seen by the same seat, unless they have used up half the arena
+    std::uint64_t steps[3];
+    int count = 0;
+    const bool follows = opts.reuseTree && followsLastRoot(state, me, steps, count);
+    for (int t = 0; t < treeCount; ++t) {
+        Tree& tree = *trees[static_cast<std::size_t>(t)];
+        const bool roomy = tree.bytes() < static_cast<std::size_t>(Tree::kMaxSlabs / 2) * Tree::kSlabBytes;
+        const bool kept = follows && roomy && reroot(tree, steps, count);
+        if (!kept) {
+            tree.clear();
+        }
+        if (t == 0 && lastPondered) {
+            lastStats.afterPonder = true;
+            lastStats.ponderHit   = kept;
+        }
+    }
+    lastRoot = state;
+    haveLastRoot = true;
+    lastObserver = me;
+    lastPondered = pondering;
+
+    // stream i for thread i: one draw from the caller, then jumps
+    workers.resize(static_cast<std::size_t>(threads));
+    Xoshiro256 stream(rng());
+    SolverOptions so;
+    so.maxTotalCards = opts.solveCards;
+    so.budgetMs      = 0.0;
+    so.table         = opts.table;
+    so.tablebase     = opts.tablebase;
+    for (auto& w : workers) {
+        w.rng = stream;
+        w.playouts    = 0;
+        w.solved      = 0;
+        w.solverNodes = 0;
+        w.ttHits      = 0;
+        w.tbHits      = 0;
+        w.nodes       = 0;
+        if (opts.solveCards > 0) {
+            w.solver.setOptions(so);
+        }
+        stream.jump();
+    }
+    // the table is only read by the playout solvers
+    if (opts.table && opts.solveCards > 0) {
+        opts.table->newSearch();
+    }
+    claimed.store(0, std::memory_order_relaxed);
+
+    if (threads == 1) {
+        runWorker(0, treeCount, state);
+    } else {
+        TaskScheduler& sched = opts.scheduler ? *opts.scheduler : TaskScheduler::global();
+        sched.parallelFor(static_cast<std::size_t>(threads), 1,
+            [&](std::size_t i, unsigned) {
+                runWorker(static_cast<int>(i), treeCount, state);
+            });
+    }
+
+    // Sum root visits per move over the trees, in tree order.
+    for (int t = 0; t < treeCount; ++t) {
+        tallyRoot(*trees[static_cast<std::size_t>(t)], tally);
+    }
+    for (int i = 0; i < threads; ++i) {
+        const Worker& w = workers[static_cast<std::size_t>(i)];
+        trees[static_cast<std::size_t>(treeCount == 1 ? 0 : i)]->addNodes(w.nodes);
+        lastStats.nodes       += static_cast<int>(w.nodes);
+        lastStats.playouts    += w.playouts;
+        lastStats.solved      += w.solved;
+        lastStats.solverNodes += w.solverNodes;
+        lastStats.ttHits      += w.ttHits;
+        lastStats.tbHits      += w.tbHits;
+    }
+    for (int t = 0; t < treeCount; ++t) {
+        lastStats.treeNodes += trees[static_cast<std::size_t>(t)]->nodes();
+        lastStats.bytes     += trees[static_cast<std::size_t>(t)]->bytes();
+    }
+    lastStats.ms = std::chrono::duration<double, std::milli>(
+                       std::chrono::steady_clock::now() - start).count();
+    progress = nullptr;
+    limits   = nullptr;
+}
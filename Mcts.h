@@ -0,0 +1,295 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Anytime.h"
+#include "CardTracker.h"
+#include "Engine.h"
+#include "Rng.h"
+#include "Solver.h"
+#include "TransTable.h"
+
+class TaskScheduler;
+
+// =========================
+// Information-set Monte Carlo tree search
+// =========================
+//
+// Single-observer ISMCTS: the player to move sees its own hand, the table
+// and how many cards everyone holds, but not how the unseen cards are split
+// between the other two seats. Every iteration
+//   1. deals the unseen cards at random (a determinization): uniformly, or
+//      through a HandSampler when a CardTracker is given,
+//   2. walks one shared tree using only moves that deal allows,
+//   3. adds one node, and
+//   4. plays random moves through the engine until someone goes out, or,
+//      with solveCards > 0, until few enough cards are left for an
+//      EndgameSolver to settle that deal exactly, or until the deal is
+//      small enough for the Tablebase.
+//
+// Nodes are identified by the rank pattern of their move (suits never
+// matter for the rules), so a node is reused by every deal that can make
+// that move. Selection is UCB1 with availability counts: the exploration
+// term only counts the parent visits in which the child was playable.
+// The reply is the most visited child of the root.
+//
+// Nodes live in a per-tree arena of 1 MB slabs that are kept between
+// decisions, so clearing a tree is O(1) and a search allocates nothing once
+// the slabs exist. A node's children are one contiguous block laid out as
+// struct-of-arrays (patterns, then visits, availability, wins, child
+// blocks, move type / rank), so a UCB scan reads a few adjacent cache lines
+// instead of chasing one pointer per child. Most nodes get only a child or
+// two, so the first block has two slots; when it fills, an overflow block
+// twice as large is chained, up to the number of moves the mover has.
+//
+// With reuseTree, a search whose position follows the previous search's by
+// at most one round (each seat moved at most once), seen by the same seat,
+// re-roots every tree at the node the moves since lead to, keeping its
+// statistics. The rest of the old tree stays in the arena until the next
+// clear.
+//
+// ponder() uses that to think on an opponent's time: it searches the
+// position where another seat is to move, from `me`'s information set, so
+// the tree's first level is the opponent's likely moves and the second our
+// replies to them. UCB spends the playouts on the moves the opponent is
+// most likely to make (the ones that score best for it). When the real move
+// is among them, the next choose() starts from that subtree (a ponder hit).
+//
+// With threads > 1 the search runs on a TaskScheduler in one of two modes:
+//   Root: every thread grows its own tree; root visit counts are summed.
+//         Thread i always uses random stream i and 1/threads of the playout
+//         budget, so with a playout budget the reply depends only on the
+//         seed and the thread count.
+//   Tree: all threads grow one tree. Visit / win / availability counters
+//         are atomics and children are pushed with a CAS, so no locks are
+//         taken; a thread descending through a node adds `virtualLoss`
+//         visits (counted as losses until its playout returns) to steer
+//         the others elsewhere. Thread timing shapes the tree, so only
+//         threads == 1 is reproducible in this mode.
+//
+// A search ends at the first of: its own budget (budgetMs / maxPlayouts),
+// the SearchLimits deadline, or the limits' stop flag. Thread 0 keeps the
+// most visited root move in a BestMove slot as it goes (every 64
+// playouts), so a caller can take a reply before choose() returns.
+//
+// The endgame solves go through one TransTable shared by all threads (and,
+// if the caller keeps it, by later decisions and other players): the same
+// small endgames come up in deal after deal. Solved values are exact, so
+// sharing the table does not change the search, only its cost.
+
+enum class MctsParallel {
+    Root,
+    Tree
+};
+
+struct MctsOptions {
+    double       budgetMs    = 800.0; // wall-clock budget per decision, <= 0: none
+    long long    maxPlayouts = 0;     // stop after this many playouts, 0: no limit
+    double       exploration = 0.7;   // UCB constant (playouts score 0 or 1)
+    int          threads     = 1;     // search threads
+    MctsParallel parallel    = MctsParallel::Root;
+    int          virtualLoss = 1;     // Tree mode, >= 1 (1 = plain UCB when alone)
+    TaskScheduler* scheduler = nullptr; // threads > 1; null: TaskScheduler::global()
+    int          solveCards  = 0;     // solve playouts exactly at <= this many cards, 0: off
+    TransTable*  table       = nullptr; // for those solves, may be null
+    const Tablebase* tablebase = nullptr; // playouts stop where it has the result
+    bool         reuseTree   = true;  // re-root the last decision's tree when it applies
+};
+
+struct MctsStats {
+    long long playouts = 0;
+    int       nodes    = 0;        // added by this decision
+    long long treeNodes = 0;       // in the arenas, incl. reused and stale ones
+    std::size_t bytes  = 0;        // arena memory in use
+    long long reusedVisits = 0;    // root visits kept by re-rooting
+    long long reusedNodes  = 0;    // nodes below the new root(s)
+    bool      afterPonder  = false; // the previous search was a ponder()
+    bool      ponderHit    = false; // ... and its tree was kept
+    double    ms       = 0.0;      // decision latency
+    long long solved      = 0;     // playouts ended by the endgame solver
+    long long solverNodes = 0;
+    long long ttHits      = 0;
+    long long tbHits      = 0;     // playouts ended by a tablebase probe
+
+    double playoutsPerSec() const { return ms > 0.0 ? playouts * 1000.0 / ms : 0.0; }
+    double nodesPerSec() const { return ms > 0.0 ? nodes * 1000.0 / ms : 0.0; }
+    double bytesPerNode() const { return treeNodes > 0 ? static_cast<double>(bytes) / treeNodes : 0.0; }
+};
+
+class IsmctsSearch {
+public:
+    explicit IsmctsSearch(const MctsOptions& opts = MctsOptions());
+    ~IsmctsSearch();
+
+    // trees are not copied; moving keeps them (Enemy / GUI state are moved)
+    IsmctsSearch(const IsmctsSearch&) = delete;
+    IsmctsSearch& operator=(const IsmctsSearch&) = delete;
+    IsmctsSearch(IsmctsSearch&& o) noexcept;
+    IsmctsSearch& operator=(IsmctsSearch&& o) noexcept;
+
+    const MctsOptions& options() const { return opts; }
+    // throws std::invalid_argument when neither budget is set, or on
+    // threads / virtualLoss < 1 or solveCards < 0
+    void setOptions(const MctsOptions& o);
+
+    // Reply for the player to move in `state`, using only what that player
+    // can see. Always runs at least one playout (unless the move is forced).
+    // With a tracker, hidden hands respect what has been played / passed.
+    // `progress`, if given, holds the best root move found so far.
+    Move choose(const GameState& state, Xoshiro256& rng,
+                const CardTracker* tracker = nullptr,
+                const SearchLimits& limits = SearchLimits(),
+                BestMove* progress = nullptr);
+
+    // Think on another seat's turn (state.currentPlayer() != me) until
+    // limits.deadline or limits.stop (or, without a deadline, the usual
+    // budget), for the choose() that follows. No-op without reuseTree.
+    void ponder(const GameState& state, int me, Xoshiro256& rng,
+                const CardTracker* tracker = nullptr,
+                const SearchLimits& limits = SearchLimits());
+
+    // playouts / nodes / latency of the last choose(); after a ponder hit,
+    // reusedVisits / reusedNodes are what the ponder left
+    const MctsStats& stats() const { return lastStats; }
+    // the same for the last ponder()
+    const MctsStats& ponderStats() const { return lastPonderStats; }
+
+private:
+    // Node storage: a bump arena over slabs that never move, so threads
+    // keep block references while others allocate. A block is a header
+    // followed by the arrays of its `capacity` child slots; a reference is
+    // the block's byte offset in the arena.
+    class Tree {
+    public:
+        static constexpr std::uint32_t kNone      = 0xFFFFFFFFu;
+        static constexpr int           kSlabBits  = 20;             // 1 MB
+        static constexpr std::uint32_t kSlabBytes = 1u << kSlabBits;
+        static constexpr int           kMaxSlabs  = 512;            // 512 MB
+        // slot patterns that are not moves: claimed but not yet written,
+        // and lost a race to an equal pattern
+        static constexpr std::uint64_t kEmpty = ~0ull;
+        static constexpr std::uint64_t kDead  = ~1ull;
+
+        struct alignas(8) Block {
+            std::atomic<std::uint32_t> count; // slots claimed (may overshoot capacity)
+            std::atomic<std::uint32_t> next;  // overflow block, kNone if none
+            std::uint16_t capacity;
+            std::int8_t   mover;              // seat that plays every child's move
+        };
+        // The arrays of one block.
+        struct Children {
+            Block* head;
+            std::atomic<std::uint64_t>* pattern; // RankCounts word: the node's identity
+            std::atomic<std::uint32_t>* visits;  // includes virtual loss in flight
+            std::atomic<std::uint32_t>* avail;   // parent visits in which it was legal
+            std::atomic<std::uint32_t>* wins;    // playouts won by the mover's team
+            std::atomic<std::uint32_t>* kids;    // the child's own children block
+            std::uint16_t* info;                 // move type << 8 | main rank
+
+            int size() const {
+                std::uint32_t n = head->count.load(std::memory_order_acquire);
+                return static_cast<int>(n < head->capacity ? n : head->capacity);
+            }
+        };
+        struct Slot {
+            std::uint32_t block = kNone;
+            int           index = 0;
+        };
+
+        Tree();
+        // O(1): forget every node, keep the slabs
+        void clear();
+        // a block of `capacity` empty slots, or kNone when the arena is full
+        std::uint32_t newBlock(int capacity, int mover);
+        Children children(std::uint32_t block);
+        // the root's children block
+        std::atomic<std::uint32_t>& root() { return rootKids; }
+
+        std::size_t bytes() const { return used.load(std::memory_order_relaxed); }
+        long long nodes() const { return nodeCount; }
+        void addNodes(long long n) { nodeCount += n; }
+
+    private:
+        std::atomic<unsigned char*> slabs[kMaxSlabs];
+        std::vector<std::unique_ptr<unsigned char[]>> owned;
+        std::atomic<std::size_t> used;
+        std::atomic<std::uint32_t> rootKids;
+        long long nodeCount; // updated between searches only
+        std::mutex growMutex;
+    };
+
+    // a game lasts at most 3 * 54 + 2 turns: the deepest tree path
+    static constexpr int kMaxPath = 3 * kCardCount + 3;
+
+    // Per-thread scratch; one cache-line aligned block each.
+    struct alignas(64) Worker {
+        Xoshiro256 rng;
+        GameState  state;
+        MoveList   moves;
+        EndgameSolver solver;
+        long long  playouts    = 0;
+        long long  solved      = 0;
+        long long  solverNodes = 0;
+        long long  ttHits      = 0;
+        long long  tbHits      = 0;
+        long long  nodes       = 0;  // slots this worker added
+        Tree::Slot path[kMaxPath];   // nodes visited by the current iteration
+    };
+
+    // Root visits per move pattern, summed over trees in tree order.
+    struct RootTally {
+        std::uint64_t patterns[kMaxGenMoves];
+        std::uint64_t visits[kMaxGenMoves];
+        std::uint16_t info[kMaxGenMoves];
+        int count = 0;
+        int best() const; // most visited, -1 if none
+    };
+
+    // choose() / ponder() body: grow the trees for `state` as seen by `me`
+    void search(const GameState& state, int me, bool pondering, Xoshiro256& rng,
+                const CardTracker* tracker, const SearchLimits& limits,
+                BestMove* progress, std::chrono::steady_clock::time_point start,
+                RootTally& tally);
+    void runWorker(int index, int treeCount, const GameState& root);
+    void tallyRoot(Tree& tree, RootTally& t);
+    void determinize(GameState& s, Xoshiro256& rng) const;
+    Tree::Slot addChild(Tree& tree, std::atomic<std::uint32_t>& kids, const Move& mv,
+                        int mover, int legal);
+    void iterate(Tree& tree, Worker& w);
+    int  playout(Worker& w);
+    // the `count` (0..3) patterns played since lastRoot, if `s` is at most
+    // one round on and `me` searched lastRoot
+    bool followsLastRoot(const GameState& s, int me, std::uint64_t steps[3], int& count) const;
+    // move the root down `count` steps; false (tree unchanged) if one is missing
+    bool reroot(Tree& tree, const std::uint64_t steps[3], int count);
+    // nodes in the subtree under `block`
+    static long long countNodes(Tree& tree, std::uint32_t block);
+
+    MctsOptions opts;
+    MctsStats   lastStats;
+    MctsStats   lastPonderStats;
+    std::vector<std::unique_ptr<Tree>> trees; // Root: one per thread, Tree: one
+    std::vector<Worker> workers;
+    std::atomic<long long> claimed;           // Tree mode: playouts started
+    MoveList    rootMoves;
+    HandSampler sampler;                      // used when choose() got a tracker
+    GameState   lastRoot;                     // state of the last search
+    bool        haveLastRoot;
+    int         lastObserver;                 // the seat it was searched for
+    bool        lastPondered;                 // it was a ponder()
+
+    // the current search: whose view, when to stop, where to report progress
+    int         observer;
+    const SearchLimits* limits;
+    bool        timed;
+    std::chrono::steady_clock::time_point deadline;
+    BestMove*   progress;
+};
+
+#endif // MCTS_H
@@ -0,0 +1,105 @@
+#include "MoveGen.h"
+
+void MoveGenerator::addSingles(CardSet hand, RankCounts rc, int aboveRank, MoveList& out) {
+    for (std::uint64_t m = rc.atLeast(1) & RankCounts::ranksAbove(aboveRank);
+         m; m = RankCounts::dropLowest(m)) {
+        int r = RankCounts::lowestRank(m);
+        out.push(HandType::Single, r, hand.takeOfRank(r, 1));
+    }
+}
+
+void MoveGenerator::addPairs(CardSet hand, RankCounts rc, int aboveRank, MoveList& out) {
+    for (std::uint64_t m = rc.atLeast(2) & RankCounts::ranksAbove(aboveRank);
+         m; m = RankCounts::dropLowest(m)) {
+        int r = RankCounts::lowestRank(m);
+        out.push(HandType::Pair, r, hand.takeOfRank(r, 2));
+    }
+}
+
+void MoveGenerator::addStraights(CardSet hand, RankCounts rc, int aboveHighRank, MoveList& out) {
+    // a straight starting at r has high rank r + 4
+    for (std::uint64_t m = rc.straightStarts(5) & RankCounts::ranksAbove(aboveHighRank - 4);
+         m; m = RankCounts::dropLowest(m)) {
+        int low = RankCounts::lowestRank(m);
+        CardSet cards;
+        for (int r = low; r < low + 5; ++r) {
+            cards |= hand.takeOfRank(r, 1);
+        }
+        out.push(HandType::Straight, low + 4, cards);
+    }
+}
+
+void MoveGenerator::addFullHouses(CardSet hand, RankCounts rc, int aboveTripleRank, MoveList& out) {
+    std::uint64_t pairs = rc.atLeast(2);
+    for (std::uint64_t t = rc.atLeast(3) & RankCounts::ranksAbove(aboveTripleRank);
+         t; t = RankCounts::dropLowest(t)) {
+        int rt = RankCounts::lowestRank(t);
+        CardSet triple = hand.takeOfRank(rt, 3);
+        for (std::uint64_t p = pairs & ~RankCounts::bit(rt); p; p = RankCounts::dropLowest(p)) {
+            int rp = RankCounts::lowestRank(p);
+            out.push(HandType::FullHouse, rt, triple | hand.takeOfRank(rp, 2));
+        }
+    }
+}
+
+void MoveGenerator::addBombs(RankCounts rc, int aboveRank, MoveList& out) {
+    for (std::uint64_t m = rc.atLeast(4) & RankCounts::ranksAbove(aboveRank);
+         m; m = RankCounts::dropLowest(m)) {
+        int r = RankCounts::lowestRank(m);
+        out.push(HandType::Bomb, r, CardSet::ofRank(r));
+    }
+}
+
+void MoveGenerator::addRocket(RankCounts rc, MoveList& out) {
+    if (rc.hasRocket()) {
+        out.push(HandType::Rocket, 100, CardSet::ofRank(16) | CardSet::ofRank(17));
+    }
+}
+
+int MoveGenerator::generate(CardSet hand, const Move& lastMove, MoveList& out) {
+    out.clear();
+    RankCounts rc = RankCounts::of(hand);
+
+    // New round: every pattern the hand can form
+    if (lastMove.type == HandType::Pass) {
+        addSingles(hand, rc, -1, out);
+        addPairs(hand, rc, -1, out);
+        addStraights(hand, rc, -1, out);
+        addFullHouses(hand, rc, -1, out);
+        addBombs(rc, -1, out);
+        addRocket(rc, out);
+        return out.count;
+    }
+
+    // Following: same type and higher, then bombs / rocket, then Pass
+    switch (lastMove.type) {
+    case HandType::Single:
+        addSingles(hand, rc, lastMove.mainRank, out);
+        break;
+    case HandType::Pair:
+        addPairs(hand, rc, lastMove.mainRank, out);
+        break;
+    case HandType::Straight:
+        if (lastMove.cards.size() == 5) {
+            addStraights(hand, rc, lastMove.mainRank, out);
+        }
+        break;
+    case HandType::FullHouse:
+        addFullHouses(hand, rc, lastMove.mainRank, out);
+        break;
+    default:
+        break;
+    }
+
+    if (lastMove.type == HandType::Bomb) {
+        addBombs(rc, lastMove.mainRank, out);
+    } else if (lastMove.type != HandType::Rocket) {
+        addBombs(rc, -1, out);
+    }
+    if (lastMove.type != HandType::Rocket) {
+        addRocket(rc, out);
+    }
+
+    out.push(HandType::Pass, -1, CardSet());
+    return out.count;
+}
@@ -0,0 +1,54 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "Card.h"
+
+// =========================
+// Legal-move generator
+// =========================
+//
+// Enumerates every reply to `lastMove` that canBeat() accepts: each single,
+// pair, 5-straight, full house, bomb and rocket the hand can form, plus Pass
+// when following. Suits never matter for the rules, so each distinct rank
+// pattern is emitted once, using the lowest suits of each rank.
+//
+// A round leader must play something, so Pass is not generated when
+// lastMove is Pass.
+
+// Upper bound for any hand: 15 singles, 13 pairs, 8 straights,
+// 13 * 12 full houses, 13 bombs, rocket, pass.
+constexpr int kMaxGenMoves = 15 + 13 + 8 + 13 * 12 + 13 + 1 + 1;
+
+// Caller-provided fixed-capacity buffer; generating never allocates.
+struct MoveList {
+    Move moves[kMaxGenMoves];
+    int     count = 0;
+
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Move& operator[](int i) const { return moves[i]; }
+    Move& operator[](int i) { return moves[i]; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+
+    void push(HandType t, int mainRank, CardSet cards) {
+        moves[count++] = Move(t, cards, mainRank);
+    }
+};
+
+class MoveGenerator {
+public:
+    // Fills `out` (cleared first) and returns the number of moves.
+    static int generate(CardSet hand, const Move& lastMove, MoveList& out);
+
+private:
+    static void addSingles(CardSet hand, RankCounts rc, int aboveRank, MoveList& out);
+    static void addPairs(CardSet hand, RankCounts rc, int aboveRank, MoveList& out);
+    static void addStraights(CardSet hand, RankCounts rc, int aboveHighRank, MoveList& out);
+    static void addFullHouses(CardSet hand, RankCounts rc, int aboveTripleRank, MoveList& out);
+    static void addBombs(RankCounts rc, int aboveRank, MoveList& out);
+    static void addRocket(RankCounts rc, MoveList& out);
+};
+
+#endif // MOVEGEN_H
@@ -0,0 +1,105 @@
+#include "MoveOrder.h"
+
+namespace {
+
+constexpr std::uint32_t kNoKiller = 0xFFFFFFFFu;
+
+// score layers, each one above everything below it: win, cards shed
+// (1..5), killer 0, killer 1, history. Shedding goes above the killers and
+// history: with win / loss values the only cutoffs are wins, and letting
+// them pull small plays ahead of long ones searched 6-100x more nodes.
+constexpr int kWinScore     = 1 << 30;
+constexpr int kShedShift    = 27;
+constexpr int kKillerScore0 = 1 << 26;
+constexpr int kKillerScore1 = 1 << 25;
+constexpr std::uint32_t kHistoryCap = (1u << 24) - 1;
+
+// the rocket's main rank is 100; it is the only move of its type, so any
+// slot will do
+int rankIndex(const Move& mv) {
+    return (mv.type == HandType::Rocket || mv.mainRank < 0) ? 0 : mv.mainRank;
+}
+
+} // namespace
+
+MoveOrderer::MoveOrderer(int maxPly)
+    : killers(), history()
+{
+    resize(maxPly);
+}
+
+void MoveOrderer::resize(int maxPly) {
+    killers.resize(static_cast<std::size_t>(maxPly > 0 ? maxPly : 0));
+    clear();
+}
+
+void MoveOrderer::clear() {
+    for (Killers& k : killers) {
+        k.key[0] = kNoKiller;
+        k.key[1] = kNoKiller;
+    }
+    for (auto& row : history) {
+        for (std::uint32_t& h : row) {
+            h = 0;
+        }
+    }
+}
+
+int MoveOrderer::score(const Move& mv, const GameState& s, int ply) const {
+    int shed = mv.cardSet.size();
+    if (shed > 0 && shed == s.handSize(s.currentPlayer())) {
+        return kWinScore;
+    }
+    int v = shed << kShedShift;
+    v += static_cast<int>(history[static_cast<int>(mv.type)][rankIndex(mv)]);
+    if (ply < static_cast<int>(killers.size())) {
+        const Killers& k = killers[static_cast<std::size_t>(ply)];
+        if (mv.key == k.key[0]) {
+            v += kKillerScore0;
+        } else if (mv.key == k.key[1]) {
+            v += kKillerScore1;
+        }
+    }
+    return v;
+}
+
+void MoveOrderer::order(MoveList& moves, const GameState& s, int ply) const {
+    int scores[kMaxGenMoves];
+    const int n = moves.size();
+    for (int i = 0; i < n; ++i) {
+        scores[i] = score(moves[i], s, ply);
+    }
+    // insertion sort: lists are short, mostly in order already, and it is stable
+    for (int i = 1; i < n; ++i) {
+        const Move mv = moves[i];
+        const int sc = scores[i];
+        int j = i - 1;
+        while (j >= 0 && scores[j] < sc) {
+            moves[j + 1] = moves[j];
+            scores[j + 1] = scores[j];
+            --j;
+        }
+        moves[j + 1] = mv;
+        scores[j + 1] = sc;
+    }
+}
+
+void MoveOrderer::recordCutoff(const Move& mv, int ply, int cardsLeft) {
+    if (ply < static_cast<int>(killers.size())) {
+        Killers& k = killers[static_cast<std::size_t>(ply)];
+        if (k.key[0] != mv.key) {
+            k.key[1] = k.key[0];
+            k.key[0] = mv.key;
+        }
+    }
+    std::uint32_t& h = history[static_cast<int>(mv.type)][rankIndex(mv)];
+    h += static_cast<std::uint32_t>(cardsLeft * cardsLeft);
+    if (h > kHistoryCap) {
+        // keep the relative weights, stay below the killer layer
+        for (auto& row : history) {
+            for (std::uint32_t& x : row) {
+                x >>= 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef MOVEORDER_H
+#define MOVEORDER_H
+
+#include <cstdint>
+#include <vector>
+#include "Engine.h"
+#include "MoveGen.h"
+
+// =========================
+// Move ordering for alpha-beta
+// =========================
+//
+// Alpha-beta only cuts when a good move is tried early, so the endgame
+// solver sorts every move list before searching it. Moves are ranked by,
+// in order of precedence:
+//
+//   - a win on the spot: the move empties the mover's hand;
+//   - a static bias for the number of cards the move sheds;
+//   - killers: the last two moves that caused a cutoff at this ply (matched
+//     by pattern key, so a killer found in one subtree also fires in its
+//     siblings, whatever the suits);
+//   - history: how often (weighted by the cards left) moves of the same
+//     (hand type, main rank) have caused cutoffs anywhere in the search.
+//
+// Sorting is stable, so ties keep MoveGenerator's order and the search
+// stays reproducible. clear() forgets everything; the solver calls it at
+// the start of each solve() so one position always gets the same tree.
+
+class MoveOrderer {
+public:
+    explicit MoveOrderer(int maxPly = 0);
+
+    // Killer slots for plies 0..maxPly-1 (deeper plies get none).
+    void resize(int maxPly);
+    void clear();
+
+    // Sort `moves` best-first for the player to move in `s` at `ply`.
+    void order(MoveList& moves, const GameState& s, int ply) const;
+
+    // `mv` caused a cutoff at `ply` with `cardsLeft` cards in play.
+    void recordCutoff(const Move& mv, int ply, int cardsLeft);
+
+    int score(const Move& mv, const GameState& s, int ply) const;
+
+private:
+    static constexpr int kTypes = 8;  // HandType values
+    static constexpr int kRanks = 18; // main ranks 0..17; the rocket uses 0
+
+    struct Killers {
+        std::uint32_t key[2];
+    };
+
+    std::vector<Killers> killers;
+    std::uint32_t history[kTypes][kRanks];
+};
+
+#endif // MOVEORDER_H
@@ -0,0 +1,377 @@
+#include "ProofSearch.h"
+
+#include <chrono>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr std::uint32_t kInf = 0x3FFFFFFF;
+constexpr std::uint32_t kWorkMask = 0xFFFFFF; // Entry::work's low 24 bits
+
+std::uint32_t addSat(std::uint32_t a, std::uint32_t b) {
+    std::uint32_t s = a + b;
+    return s >= kInf ? kInf : s;
+}
+
+// The whole hand as one move, if it is a valid hand (a Pass otherwise)
+Move wholeHand(CardSet hand) {
+    if (hand.size() > kMaxMoveCards) {
+        return Move();
+    }
+    auto info = analyzeHand(hand);
+    if (info.first == HandType::Invalid) {
+        return Move();
+    }
+    return Move(info.first, hand, info.second);
+}
+
+void printNode(std::ostream& os, const ProofTree& t, int idx, int depth, int maxDepth) {
+    const ProofTreeNode& n = t.nodes[static_cast<std::size_t>(idx)];
+    if (idx != 0) {
+        os << std::string(static_cast<std::size_t>(2 * (depth - 1)), ' ')
+           << "P" << n.seat << ": ";
+        if (n.move.isPass()) {
+            os << "Pass";
+        } else {
+            os << handTypeToString(n.move.type);
+            for (const Card& c : toCards(n.move.cardSet)) {
+                os << ' ' << c.toString();
+            }
+        }
+        os << '\n';
+    }
+    if (maxDepth >= 0 && depth >= maxDepth) {
+        return;
+    }
+    for (int c = n.firstChild; c >= 0; c = t.nodes[static_cast<std::size_t>(c)].nextSibling) {
+        printNode(os, t, c, depth + 1, maxDepth);
+    }
+}
+
+} // namespace
+
+void ProofTree::print(std::ostream& os, int maxDepth) const {
+    if (!nodes.empty()) {
+        printNode(os, *this, 0, 0, maxDepth);
+    }
+}
+
+// ======================
+// ProofNumberSearch
+// ======================
+
+ProofNumberSearch::ProofNumberSearch(const ProofOptions& o)
+    : opts(), table(), mask(0), generation(0), frames(), orderer(), scratch(), nodes(0), budget(0),
+      aborted(false)
+{
+    setOptions(o);
+}
+
+void ProofNumberSearch::setOptions(const ProofOptions& o) {
+    if (o.maxNodes <= 0) {
+        throw std::invalid_argument("ProofOptions: maxNodes must be > 0");
+    }
+    if (o.tableMb == 0) {
+        throw std::invalid_argument("ProofOptions: tableMb must be > 0");
+    }
+    // a power of two number of buckets, at least one
+    std::size_t want = o.tableMb * 1024 * 1024 / sizeof(Bucket);
+    std::size_t count = 1;
+    while (count * 2 <= want) {
+        count *= 2;
+    }
+    table.assign(count, Bucket());
+    mask = count - 1;
+    generation = 0;
+    opts = o;
+}
+
+const ProofNumberSearch::Entry* ProofNumberSearch::probe(std::uint64_t key) const {
+    const Bucket& b = table[static_cast<std::size_t>(key) & mask];
+    const std::uint32_t check = static_cast<std::uint32_t>(key >> 32);
+    for (const Entry& e : b.e) {
+        if (e.check == check && (e.pn | e.dn) != 0) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+// same key, else an empty slot, else one from an older search, else the
+// one with the least work behind it
+void ProofNumberSearch::store(std::uint64_t key, std::uint32_t pn, std::uint32_t dn,
+                              std::uint32_t work) {
+    Bucket& b = table[static_cast<std::size_t>(key) & mask];
+    const std::uint32_t check = static_cast<std::uint32_t>(key >> 32);
+    Entry* slot = nullptr;
+    int slotRank = 0;
+    for (Entry& e : b.e) {
+        if (e.check == check || (e.pn | e.dn) == 0) {
+            slot = &e;
+            break;
+        }
+        // older searches first, then less work
+        const bool old = (e.work >> 24) != (generation & 0xFF);
+        const int rank = (old ? 0 : kWorkMask + 1) + static_cast<int>(e.work & kWorkMask);
+        if (!slot || rank < slotRank) {
+            slot = &e;
+            slotRank = rank;
+        }
+    }
+    slot->check = check;
+    slot->pn    = pn;
+    slot->dn    = dn;
+    slot->work  = (work < kWorkMask ? work : kWorkMask) | ((generation & 0xFF) << 24);
+}
+
+void ProofNumberSearch::evaluate(const GameState& s, std::uint32_t& pn, std::uint32_t& dn,
+                                 std::uint32_t* work) const {
+    if (work) {
+        *work = 0;
+    }
+    bool settled = s.isTerminal();
+    bool landlordWins = settled && s.landlordWon();
+    if (!settled) {
+        int me = s.currentPlayer();
+        if (canBeat(s.lastMove(), wholeHand(s.hand(me)))) {
+            settled = true;
+            landlordWins = s.sameTeam(me, s.landlord());
+        }
+    }
+    if (settled) {
+        pn = landlordWins ? 0 : kInf;
+        dn = landlordWins ? kInf : 0;
+    } else if (const Entry* e = probe(s.hash())) {
+        pn = e->pn;
+        dn = e->dn;
+        if (work) {
+            *work = e->work & kWorkMask;
+        }
+    } else {
+        // a side with fewer cards to shed is likely cheaper to settle for:
+        // the landlord's hand for the proof, the shorter peasant hand for
+        // the disproof
+        const int lord = s.landlord();
+        int peasant = kCardCount;
+        for (int i = 0; i < 3; ++i) {
+            if (i != lord && s.handSize(i) < peasant) {
+                peasant = s.handSize(i);
+            }
+        }
+        pn = 1 + static_cast<std::uint32_t>(s.handSize(lord)) / 2;
+        dn = 1 + static_cast<std::uint32_t>(peasant) / 2;
+    }
+}
+
+// Multiple iterative deepening (Nagai): expand `s` and keep searching its
+// most-proving child, with thresholds that send control back up as soon as
+// the second-best child would be cheaper, until `s` itself passes
+// (thpn, thdn).
+void ProofNumberSearch::mid(GameState& s, int ply, std::uint32_t thpn, std::uint32_t thdn,
+                            std::uint32_t& pn, std::uint32_t& dn, std::uint32_t& work) {
+    ++nodes;
+    const long long startNodes = nodes;
+    const bool orNode = s.currentPlayer() == s.landlord();
+    Frame& f = frames[static_cast<std::size_t>(ply)];
+    s.legalMoves(f.moves);
+    orderer.order(f.moves, s, ply);
+    int n = f.moves.size();
+    for (int i = 0; i < n; ++i) {
+        Child& c = f.children[i];
+        c.move = f.moves[i];
+        UndoRecord u = s.apply(c.move);
+        evaluate(s, c.pn, c.dn, &c.work);
+        s.undo(u);
+        if ((orNode ? c.pn : c.dn) == 0) {
+            n = i + 1; // settles this node; the rest need not be looked at
+            break;
+        }
+    }
+
+    for (;;) {
+        // OR: pn = min, dn = sum; AND: the other way round. `best` is the
+        // child with the smallest min-side number, `second` the next one.
+        std::uint32_t minSide = kInf, sumSide = 0, second = kInf;
+        int best = 0;
+        for (int i = 0; i < n; ++i) {
+            const Child& c = f.children[i];
+            const std::uint32_t m = orNode ? c.pn : c.dn;
+            sumSide = addSat(sumSide, orNode ? c.dn : c.pn);
+            if (m < minSide) {
+                second = minSide;
+                minSide = m;
+                best = i;
+            } else if (m < second) {
+                second = m;
+            }
+        }
+        pn = orNode ? minSide : sumSide;
+        dn = orNode ? sumSide : minSide;
+        if (pn >= thpn || dn >= thdn || aborted) {
+            break;
+        }
+        if (nodes >= budget) {
+            aborted = true;
+            break;
+        }
+
+        Child& c = f.children[best];
+        // 1 + epsilon trick: let the child run a little past the second
+        // best, so the search does not bounce between two close siblings
+        const std::uint32_t secondTh = addSat(second, 1 + second / 4);
+        std::uint32_t cpn, cdn;
+        if (orNode) {
+            cpn = thpn < secondTh ? thpn : secondTh;
+            cdn = thdn - dn + c.dn;
+        } else {
+            cpn = thpn - pn + c.pn;
+            cdn = thdn < secondTh ? thdn : secondTh;
+        }
+        UndoRecord u = s.apply(c.move);
+        mid(s, ply + 1, cpn, cdn, c.pn, c.dn, c.work);
+        s.undo(u);
+    }
+    const long long total = work + (nodes - startNodes + 1);
+    work = total < kWorkMask ? static_cast<std::uint32_t>(total) : kWorkMask;
+    store(s.hash(), pn, dn, work);
+}
+
+ProofResult ProofNumberSearch::landlordWins(const GameState& state) {
+    if (state.isTerminal()) {
+        throw std::logic_error("ProofNumberSearch::landlordWins: the game is over");
+    }
+    auto start = std::chrono::steady_clock::now();
+    ProofResult r;
+
+    // every turn of a round but the lead can be a pass, so a game with n
+    // cards left lasts at most 3n more turns
+    const int maxPly = 3 * state.totalCards() + 3;
+    if (static_cast<int>(frames.size()) < maxPly) {
+        frames.resize(static_cast<std::size_t>(maxPly));
+    }
+    orderer.resize(0);
+    ++generation;
+    nodes   = 0;
+    budget  = opts.maxNodes;
+    aborted = false;
+
+    GameState s = state;
+    std::uint32_t pn, dn, work;
+    evaluate(s, pn, dn, &work);
+    if (pn != 0 && dn != 0) {
+        mid(s, 0, kInf, kInf, pn, dn, work);
+    }
+
+    if (pn == 0) {
+        r.status = ProofStatus::Proven;
+    } else if (dn == 0) {
+        r.status = ProofStatus::Disproven;
+    }
+    r.nodes = nodes;
+    auto searched = std::chrono::steady_clock::now();
+    if (r.status != ProofStatus::Unknown) {
+        extractProof(r.status == ProofStatus::Proven, state, r.proof);
+    }
+    auto end = std::chrono::steady_clock::now();
+    r.ms      = std::chrono::duration<double, std::milli>(end - start).count();
+    r.proofMs = std::chrono::duration<double, std::milli>(end - searched).count();
+    return r;
+}
+
+// Is `s` settled the way the proof needs (pn == 0 if `proven`, else
+// dn == 0)? Positions the table no longer holds are searched again, without
+// a budget: they were settled once already.
+bool ProofNumberSearch::settledFor(GameState& s, bool proven) {
+    std::uint32_t pn, dn, work;
+    evaluate(s, pn, dn, &work);
+    if (pn != 0 && dn != 0) {
+        budget  = std::numeric_limits<long long>::max();
+        aborted = false;
+        mid(s, 0, kInf, kInf, pn, dn, work);
+    }
+    return proven ? pn == 0 : dn == 0;
+}
+
+// Walk the settled positions from the root: the winner's side keeps one
+// settled move, the loser's side every move (each
+// of them is settled, so the winner finds a move there in turn). A
+// position settled because its player throws the whole hand gets that move
+// as its only child.
+void ProofNumberSearch::extractProof(bool proven, const GameState& root, ProofTree& out) {
+    out.nodes.clear();
+    out.nodes.push_back({ Move(), -1, -1, -1, -1 });
+
+    struct Pending {
+        int       proofIdx;
+        GameState state;
+    };
+    std::vector<Pending> stack;
+    stack.push_back({ 0, root });
+
+    auto addChild = [&](int parent, const Move& mv, int seat) {
+        int idx = static_cast<int>(out.nodes.size());
+        ProofTreeNode& p = out.nodes[static_cast<std::size_t>(parent)];
+        out.nodes.push_back({ mv, seat, parent, -1, p.firstChild });
+        out.nodes[static_cast<std::size_t>(parent)].firstChild = idx;
+        return idx;
+    };
+
+    while (!stack.empty()) {
+        if (static_cast<long long>(out.nodes.size()) > opts.maxNodes) {
+            out.nodes.clear();
+            return;
+        }
+        Pending f = stack.back();
+        stack.pop_back();
+        if (f.state.isTerminal()) {
+            continue;
+        }
+        const int seat = f.state.currentPlayer();
+        Move all = wholeHand(f.state.hand(seat));
+        if (canBeat(f.state.lastMove(), all)) {
+            addChild(f.proofIdx, all, seat);
+            continue;
+        }
+        // the side this proof is for: one child; the other side: all
+        const bool winnerMoves = (seat == f.state.landlord()) == proven;
+        f.state.legalMoves(scratch);
+        const MoveList moves = scratch;
+        int keep = -1;
+        if (winnerMoves) {
+            // of the moves the table has settled, the one that took the
+            // least work (its proof is likely the smallest); else search
+            // move by move
+            std::uint32_t keepWork = 0;
+            for (int i = 0; i < moves.size() && !(keep >= 0 && keepWork == 0); ++i) {
+                GameState next = f.state;
+                next.apply(moves[i]);
+                std::uint32_t pn, dn, work;
+                evaluate(next, pn, dn, &work);
+                if ((proven ? pn == 0 : dn == 0) && (keep < 0 || work < keepWork)) {
+                    keep = i;
+                    keepWork = work;
+                }
+            }
+            for (int i = 0; i < moves.size() && keep < 0; ++i) {
+                GameState next = f.state;
+                next.apply(moves[i]);
+                if (settledFor(next, proven)) {
+                    keep = i;
+                }
+            }
+        }
+        // children are pushed in reverse so the sibling lists keep move order
+        for (int i = moves.size() - 1; i >= 0; --i) {
+            if (winnerMoves && i != keep) {
+                continue;
+            }
+            GameState next = f.state;
+            next.apply(moves[i]);
+            int p = addChild(f.proofIdx, moves[i], seat);
+            stack.push_back({ p, next });
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#ifndef PROOFSEARCH_H
+#define PROOFSEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "Engine.h"
+#include "MoveGen.h"
+#include "MoveOrder.h"
+
+// =========================
+// Proof-number search: "does the landlord win?"
+// =========================
+//
+// A yes / no question about a fully known position, answered without
+// caring by how much: landlord-to-move nodes are OR nodes (one winning
+// move proves them), peasant-to-move nodes are AND nodes (every reply has
+// to lose). Every node has a proof number (how many leaves still have to be
+// settled to prove "landlord wins") and a disproof number (the same for the
+// peasants), and the search always works on the most-proving node.
+//
+// It is depth-first proof-number search (df-pn): instead of keeping the tree
+// in memory and walking down from the root for every expansion, it stays
+// in a subtree until that subtree's numbers pass thresholds handed down by
+// its parent, i.e. until some other line has become cheaper. Numbers are
+// kept in a hash table keyed by GameState::hash(), so a subtree that is
+// left and re-entered, or reached again by another move order (Pass and a
+// different single first, say), starts from where it was. A game always
+// moves forward (a pass never leads), so the positions form a DAG and the
+// table needs no cycle handling. The table lives as long as the search
+// object: entries from earlier calls are still right, they are just
+// replaced first.
+//
+// Moves come from GameState::legalMoves (MoveGenerator, i.e. canBeat),
+// sorted by MoveOrderer (going out first, then the most cards shed). A
+// position whose player can throw the whole hand as one move that beats
+// the table is settled on the spot (checked with analyzeHand / canBeat).
+// A position not searched yet starts from a guess: half the landlord's
+// cards for the proof number, half the shorter peasant hand for the
+// disproof number, which takes about half the nodes of starting at 1.
+//
+// The search stops at a node budget. A settled answer comes with its proof
+// tree: at the winning side's nodes the one move that wins, at the other
+// side's nodes every legal reply. It is read back from the table, and any
+// position the table has since lost is searched again. The proof is a
+// tree, so a position reached by several lines is written out once per
+// line; one that would take more than maxNodes moves is left out.
+
+enum class ProofStatus {
+    Proven,     // the landlord wins against any defence
+    Disproven,  // the peasants win against any play
+    Unknown     // node budget ran out
+};
+
+struct ProofOptions {
+    long long   maxNodes = 2000000; // positions searched (and proof moves kept), > 0
+    std::size_t tableMb  = 16;      // proof / disproof number table
+};
+
+// One node of a proof tree: the move that leads to it. Node 0 is the root
+// position (move = Pass, seat = -1).
+struct ProofTreeNode {
+    Move move;
+    int  seat;         // who played `move`
+    int  parent;
+    int  firstChild;   // -1: leaf (the game is over after `move`)
+    int  nextSibling;
+};
+
+struct ProofTree {
+    std::vector<ProofTreeNode> nodes;
+
+    bool empty() const { return nodes.empty(); }
+    // Indented move list, `maxDepth` plies deep (-1: all of it).
+    void print(std::ostream& os, int maxDepth = -1) const;
+};
+
+struct ProofResult {
+    ProofStatus status = ProofStatus::Unknown;
+    long long   nodes  = 0;    // positions searched (move lists generated)
+    double      ms     = 0.0;  // search and proof
+    double      proofMs = 0.0; // of `ms`, writing out the proof tree
+    ProofTree   proof;         // empty while Unknown, or over maxNodes moves
+};
+
+class ProofNumberSearch {
+public:
+    explicit ProofNumberSearch(const ProofOptions& opts = ProofOptions());
+
+    const ProofOptions& options() const { return opts; }
+    // throws std::invalid_argument on maxNodes <= 0 or tableMb == 0
+    void setOptions(const ProofOptions& o);
+
+    // Throws std::logic_error on a finished game.
+    ProofResult landlordWins(const GameState& state);
+
+private:
+    // 16 bytes; four to a cache line, like TransTable's buckets
+    struct Entry {
+        std::uint32_t check; // high half of the key (the low half picks the bucket)
+        std::uint32_t pn;    // cost to prove "landlord wins" here
+        std::uint32_t dn;    // cost to disprove it; pn == dn == 0: empty slot
+        std::uint32_t work;  // positions searched below (24 bits), landlordWins() call (8)
+    };
+    static constexpr int kWays = 4;
+    struct alignas(64) Bucket {
+        Entry e[kWays];
+    };
+    struct Child {
+        Move          move;
+        std::uint32_t pn;
+        std::uint32_t dn;
+        std::uint32_t work;
+    };
+    // one per ply: the move list and its children's numbers
+    struct Frame {
+        MoveList moves;
+        Child    children[kMaxGenMoves];
+    };
+
+    const Entry* probe(std::uint64_t key) const; // null: not in the table
+    void store(std::uint64_t key, std::uint32_t pn, std::uint32_t dn, std::uint32_t work);
+    // numbers of a position without searching it: settled if the game is
+    // over or the mover goes out, else the table's, else a guess from the
+    // hand sizes; `work` is the table's work, 0 if none
+    void evaluate(const GameState& s, std::uint32_t& pn, std::uint32_t& dn,
+                  std::uint32_t* work = nullptr) const;
+    // search `s` until its numbers reach (thpn, thdn) or it is settled;
+    // `work` comes in as the table's and goes out with this search added
+    void mid(GameState& s, int ply, std::uint32_t thpn, std::uint32_t thdn,
+             std::uint32_t& pn, std::uint32_t& dn, std::uint32_t& work);
+    // settled numbers of `s`, searching it again if the table lost them
+    bool settledFor(GameState& s, bool proven);
+    void extractProof(bool proven, const GameState& root, ProofTree& out);
+
+    ProofOptions opts;
+    std::vector<Bucket> table;
+    std::size_t mask;
+    std::uint32_t generation;
+    std::vector<Frame> frames;
+    MoveOrderer orderer;
+    MoveList scratch;
+    long long nodes;
+    long long budget;
+    bool aborted;
+};
+
+#endif // PROOFSEARCH_H
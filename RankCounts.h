@@ -0,0 +1,122 @@
+#ifndef RANKCOUNTS_H
+#define RANKCOUNTS_H
+
+#include <cstdint>
+#include "CardSet.h"
+
+// =========================
+// Packed rank histogram (SWAR)
+// =========================
+//
+// One 4-bit counter per rank 3..17 in a single 64-bit word:
+//   nibble (rank - 3) holds how many cards of that rank there are (0..4).
+// Suits never matter for pattern detection, so every "is there a pair /
+// triple / bomb / straight" question becomes a few adds and masks.
+//
+// Rank masks returned by atLeast() / straightStarts() etc. keep one bit per
+// rank at the low bit of its nibble (bit 4 * (rank - 3)); use lowestRank()
+// and dropLowest() to walk them.
+
+class RankCounts {
+public:
+    static constexpr std::uint64_t kOnes      = 0x0111111111111111ull; // 15 ranks
+    static constexpr std::uint64_t kHighs     = kOnes << 3;
+    static constexpr std::uint64_t kNormal    = 0x0000111111111111ull; // ranks 3..14 (straight ranks)
+    static constexpr std::uint64_t kJokerBits = 0x0110000000000000ull; // ranks 16, 17
+
+    constexpr RankCounts() : w_(0) {}
+    constexpr explicit RankCounts(std::uint64_t w) : w_(w) {}
+
+    // O(1): nibble-wise popcount of the 4 suit bits of every normal rank,
+    // jokers moved from bits 52/53 to the low bits of nibbles 13/14.
+    static RankCounts of(CardSet s) {
+        std::uint64_t b = s.bits();
+        std::uint64_t x = b & 0x000FFFFFFFFFFFFFull;
+        x = x - ((x >> 1) & 0x0005555555555555ull);
+        x = (x & 0x0003333333333333ull) + ((x >> 2) & 0x0003333333333333ull);
+        x |= ((b >> kSmallJokerId) & 1u) << 52;
+        x |= ((b >> kBigJokerId)   & 1u) << 56;
+        return RankCounts(x);
+    }
+
+    static constexpr int shift(int rank) { return (rank - 3) * 4; }
+    static constexpr std::uint64_t bit(int rank) { return std::uint64_t{1} << shift(rank); }
+
+    // Rank-mask bits for every rank strictly greater than `rank`
+    static constexpr std::uint64_t ranksAbove(int rank) {
+        return rank < 3 ? kOnes : (rank >= 17 ? 0 : kOnes & ~((bit(rank + 1)) - 1));
+    }
+
+    static int lowestRank(std::uint64_t mask) { return 3 + ctz64(mask) / 4; }
+    static std::uint64_t dropLowest(std::uint64_t mask) { return mask & (mask - 1); }
+    static int rankCount(std::uint64_t mask) { return popcount64(mask); }
+
+    constexpr std::uint64_t word() const { return w_; }
+    constexpr bool empty() const { return w_ == 0; }
+
+    constexpr int count(int rank) const { return static_cast<int>((w_ >> shift(rank)) & 0xF); }
+    void add(int rank, int n = 1)    { w_ += static_cast<std::uint64_t>(n) << shift(rank); }
+    void remove(int rank, int n = 1) { w_ -= static_cast<std::uint64_t>(n) << shift(rank); }
+
+    // Counts never exceed 4, so nibbles cannot carry into each other.
+    RankCounts& operator+=(RankCounts o) { w_ += o.w_; return *this; }
+    RankCounts& operator-=(RankCounts o) { w_ -= o.w_; return *this; }
+    constexpr RankCounts operator+(RankCounts o) const { return RankCounts(w_ + o.w_); }
+    constexpr RankCounts operator-(RankCounts o) const { return RankCounts(w_ - o.w_); }
+    constexpr bool operator==(RankCounts o) const { return w_ == o.w_; }
+    constexpr bool operator!=(RankCounts o) const { return w_ != o.w_; }
+
+    // Total number of cards: sum of all nibbles
+    int total() const {
+        std::uint64_t x = (w_ & 0x0F0F0F0F0F0F0F0Full) + ((w_ >> 4) & 0x0F0F0F0F0F0F0F0Full);
+        return static_cast<int>((x * 0x0101010101010101ull) >> 56);
+    }
+
+    // Ranks holding at least k (1..4) cards: nibble + (8 - k) reaches bit 3
+    // exactly when nibble >= k, and never overflows the nibble.
+    constexpr std::uint64_t atLeast(int k) const {
+        return ((w_ + kOnes * static_cast<std::uint64_t>(8 - k)) & kHighs) >> 3;
+    }
+
+    // Ranks r such that r..r+len-1 are all present and r+len-1 <= 14 (A)
+    std::uint64_t straightStarts(int len = 5) const {
+        std::uint64_t m = atLeast(1) & kNormal;
+        std::uint64_t s = m;
+        for (int i = 1; i < len; ++i) {
+            s &= m >> (4 * i);
+        }
+        return s;
+    }
+
+    bool hasPair()   const { return atLeast(2) != 0; }
+    bool hasTriple() const { return atLeast(3) != 0; }
+    bool hasBomb()   const { return atLeast(4) != 0; }
+    bool hasRocket() const { return (w_ & kJokerBits) == kJokerBits; }
+    bool hasStraight(int len = 5) const { return straightStarts(len) != 0; }
+
+    // a triple plus a pair of a different rank (the triple rank may itself be a bomb)
+    bool hasFullHouse() const {
+        return atLeast(3) != 0 && rankCount(atLeast(2)) >= 2;
+    }
+
+    // every nibble >= the same nibble of `o` (nibble + 8 - o keeps bit 3)
+    bool covers(RankCounts o) const {
+        return (((w_ + (kOnes << 3)) - o.w_) & kHighs) == kHighs;
+    }
+
+private:
+    std::uint64_t w_;
+};
+
+// The cards of `hand` with histogram `need`, lowest suits of each rank first.
+// `hand` must cover `need`.
+inline CardSet takeCounts(CardSet hand, RankCounts need) {
+    CardSet out;
+    for (std::uint64_t m = need.atLeast(1); m; m = RankCounts::dropLowest(m)) {
+        int r = RankCounts::lowestRank(m);
+        out |= hand.takeOfRank(r, need.count(r));
+    }
+    return out;
+}
+
+#endif // RANKCOUNTS_H
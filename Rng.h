@@ -0,0 +1,84 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+#include <limits>
+
+// =========================
+// Fast seedable RNG (xoshiro256**)
+// =========================
+//
+// Small, fast and reproducible: the same 64-bit seed always gives the same
+// sequence on every platform (unlike std::default_random_engine).
+// Satisfies UniformRandomBitGenerator, so it also works with <random>
+// distributions and std::shuffle.
+
+class Xoshiro256 {
+public:
+    using result_type = std::uint64_t;
+
+    explicit Xoshiro256(std::uint64_t seed = 0) { reseed(seed); }
+
+    // splitmix64 expands the seed into the 256-bit state
+    void reseed(std::uint64_t seed) {
+        for (auto& w : s_) {
+            seed += 0x9E3779B97F4A7C15ull;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            w = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const std::uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const std::uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    // uniform in [0, n), Lemire's multiply-shift (bias < 2^-32 for small n)
+    std::uint32_t below(std::uint32_t n) {
+        return static_cast<std::uint32_t>(((operator()() >> 32) * n) >> 32);
+    }
+
+    // uniform in [0, 1)
+    double uniform() {
+        return static_cast<double>(operator()() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Advance 2^128 steps: gives non-overlapping streams for worker threads.
+    void jump() {
+        static const std::uint64_t kJump[] = {
+            0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+            0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull
+        };
+        std::uint64_t t[4] = { 0, 0, 0, 0 };
+        for (std::uint64_t j : kJump) {
+            for (int b = 0; b < 64; ++b) {
+                if (j & (std::uint64_t{1} << b)) {
+                    for (int i = 0; i < 4; ++i) t[i] ^= s_[i];
+                }
+                operator()();
+            }
+        }
+        for (int i = 0; i < 4; ++i) s_[i] = t[i];
+    }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::uint64_t s_[4];
+};
+
+#endif // RNG_H
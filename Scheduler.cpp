@@ -0,0 +1,281 @@
+#include "Scheduler.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+thread_local const TaskScheduler* tlsScheduler = nullptr;
+thread_local int tlsWorker = -1;
+
+std::uint64_t nextRandom(std::uint64_t& s) {
+    // xorshift64*: only used to pick steal victims
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    return s * 0x2545F4914F6CDD1Dull;
+}
+
+void pinCurrentThread(unsigned cpu) {
+#if defined(__linux__)
+    unsigned n = std::thread::hardware_concurrency();
+    if (n == 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % n, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu; // no portable affinity API (e.g. macOS): run unpinned
+#endif
+}
+
+} // namespace
+
+// ======================
+// TaskDeque
+// ======================
+
+void TaskScheduler::TaskDeque::lock() {
+    int spins = 0;
+    while (busy.exchange(true, std::memory_order_acquire)) {
+        while (busy.load(std::memory_order_relaxed)) {
+            if (++spins > 64) {
+                std::this_thread::yield();
+                spins = 0;
+            }
+        }
+    }
+}
+
+bool TaskScheduler::TaskDeque::pushBottom(const Task& t) {
+    lock();
+    std::size_t b = bottom.load(std::memory_order_relaxed);
+    if (b - top.load(std::memory_order_relaxed) >= kCapacity) {
+        unlock();
+        return false;
+    }
+    tasks[b % kCapacity] = t;
+    bottom.store(b + 1, std::memory_order_relaxed);
+    unlock();
+    return true;
+}
+
+bool TaskScheduler::TaskDeque::popBottom(Task& t) {
+    if (probablyEmpty()) return false;
+    lock();
+    std::size_t b = bottom.load(std::memory_order_relaxed);
+    if (b == top.load(std::memory_order_relaxed)) {
+        unlock();
+        return false;
+    }
+    --b;
+    t = tasks[b % kCapacity];
+    bottom.store(b, std::memory_order_relaxed);
+    unlock();
+    return true;
+}
+
+bool TaskScheduler::TaskDeque::stealTop(Task& t) {
+    if (probablyEmpty()) return false;
+    lock();
+    std::size_t tp = top.load(std::memory_order_relaxed);
+    if (tp == bottom.load(std::memory_order_relaxed)) {
+        unlock();
+        return false;
+    }
+    t = tasks[tp % kCapacity];
+    top.store(tp + 1, std::memory_order_relaxed);
+    unlock();
+    return true;
+}
+
+// ======================
+// TaskScheduler
+// ======================
+
+TaskScheduler::TaskScheduler(unsigned threads, bool pinThreads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+    }
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->rng = 0x9E3779B97F4A7C15ull * (i + 1);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers[i]->thread = std::thread([this, i, pinThreads] {
+            if (pinThreads) {
+                pinCurrentThread(i);
+            }
+            workerLoop(i);
+        });
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    stopping.store(true);
+    wake();
+    for (auto& w : workers) {
+        w->thread.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::global() {
+    static TaskScheduler instance;
+    return instance;
+}
+
+int TaskScheduler::currentWorker() const {
+    return tlsScheduler == this ? tlsWorker : -1;
+}
+
+void TaskScheduler::wake() {
+    epoch.fetch_add(1);
+    if (sleepers.load() > 0) {
+        { std::lock_guard<std::mutex> lk(sleepMutex); }
+        sleepCv.notify_all();
+    }
+}
+
+void TaskScheduler::submitExternal(const Task& t) {
+    {
+        std::lock_guard<std::mutex> lk(injectMutex);
+        injected.push_back(t);
+        injectedCount.store(injected.size());
+    }
+    wake();
+}
+
+void TaskScheduler::run(Job& job, std::size_t n) {
+    Task root{ &job, 0, n };
+    int self = currentWorker();
+
+    if (self < 0) {
+        // external caller: hand the range to the pool and block
+        submitExternal(root);
+        std::unique_lock<std::mutex> lk(waitMutex);
+        waitCv.wait(lk, [&] { return job.pending.load() == 0; });
+        return;
+    }
+
+    // inside a task: keep working (own tasks first, then steal) until done
+    unsigned w = static_cast<unsigned>(self);
+    execute(root, w);
+    Task t;
+    while (job.pending.load(std::memory_order_acquire) != 0) {
+        if (findTask(w, t)) {
+            execute(t, w);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TaskScheduler::execute(const Task& task, unsigned worker) {
+    Job* job = task.job;
+    std::size_t begin = task.begin;
+    std::size_t end   = task.end;
+
+    // lazy binary splitting: leave the upper half for thieves
+    while (end - begin > job->grain) {
+        std::size_t mid = begin + (end - begin) / 2;
+        if (!workers[worker]->deque.pushBottom(Task{ job, mid, end })) {
+            break; // deque full: just run the rest here
+        }
+        // Dekker handshake with workerLoop: publish the task, then look for
+        // sleepers; a worker going to sleep counts itself, then looks for
+        // tasks. The fences make sure at least one side sees the other.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_seq_cst) > 0) {
+            wake();
+        }
+        end = mid;
+    }
+
+    for (std::size_t i = begin; i < end; ++i) {
+        job->fn(job->ctx, i, worker);
+    }
+
+    std::size_t done = end - begin;
+    if (job->pending.fetch_sub(done, std::memory_order_acq_rel) == done) {
+        // last piece: `job` may be destroyed by its owner from here on
+        { std::lock_guard<std::mutex> lk(waitMutex); }
+        waitCv.notify_all();
+    }
+}
+
+bool TaskScheduler::stealFrom(unsigned thief, Task& out) {
+    unsigned n = threadCount();
+    if (n < 2) return false;
+    unsigned start = static_cast<unsigned>(nextRandom(workers[thief]->rng) % n);
+    for (unsigned k = 0; k < n; ++k) {
+        unsigned victim = (start + k) % n;
+        if (victim != thief && workers[victim]->deque.stealTop(out)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::findTask(unsigned worker, Task& out) {
+    if (workers[worker]->deque.popBottom(out)) {
+        return true;
+    }
+    if (injectedCount.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lk(injectMutex);
+        if (!injected.empty()) {
+            out = injected.back();
+            injected.pop_back();
+            injectedCount.store(injected.size());
+            return true;
+        }
+    }
+    return stealFrom(worker, out);
+}
+
+bool TaskScheduler::workVisible() const {
+    if (injectedCount.load() > 0) {
+        return true;
+    }
+    for (const auto& w : workers) {
+        if (!w->deque.probablyEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::workerLoop(unsigned index) {
+    tlsScheduler = this;
+    tlsWorker    = static_cast<int>(index);
+
+    Task t;
+    int idle = 0;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        std::uint64_t seen = epoch.load();
+        if (findTask(index, t)) {
+            execute(t, index);
+            idle = 0;
+            continue;
+        }
+        if (++idle < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // nothing to do for a while: sleep until new work is published.
+        // Tasks pushed before we counted ourselves skipped wake(), so look
+        // at the deques again once counted (see execute()).
+        std::unique_lock<std::mutex> lk(sleepMutex);
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        sleepCv.wait(lk, [&] {
+            return epoch.load() != seen || stopping.load() || workVisible();
+        });
+        sleepers.fetch_sub(1);
+        idle = 0;
+    }
+}
@@ -0,0 +1,138 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// =========================
+// Work-stealing task scheduler
+// =========================
+//
+// One fixed-capacity deque per worker thread. A worker pushes and pops
+// tasks at the bottom of its own deque (LIFO, cache-warm); idle workers
+// steal from the top of a random victim (FIFO, largest pieces first).
+//
+// Work is submitted as index ranges: parallelFor(n, grain, fn) runs
+// fn(i, worker) for every i in [0, n). A range task splits itself in half
+// and pushes the upper half until it is at most `grain` items, so a
+// million one-game tasks cost a few dozen pushes per thread, and threads
+// that finish early steal the remaining halves instead of idling at the
+// tail.
+//
+// parallelFor may be called from outside (the caller blocks) or from inside
+// a task (the calling worker keeps executing and stealing while it waits),
+// so a parallel simulation can run parallel searches inside it.
+
+class TaskScheduler {
+public:
+    // threads = 0: one worker per hardware thread.
+    // pinThreads: bind worker i to CPU i (Linux only; ignored elsewhere).
+    explicit TaskScheduler(unsigned threads = 0, bool pinThreads = false);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()); }
+
+    // Index of the calling worker thread in this scheduler, or -1.
+    int currentWorker() const;
+
+    // fn(std::size_t index, unsigned worker) for every index in [0, n).
+    template <class Fn>
+    void parallelFor(std::size_t n, std::size_t grain, Fn&& fn) {
+        if (n == 0) return;
+        Job job;
+        job.grain = grain ? grain : 1;
+        job.fn    = &invoke<typename std::remove_reference<Fn>::type>;
+        job.ctx   = const_cast<void*>(static_cast<const void*>(&fn));
+        job.pending.store(n, std::memory_order_relaxed);
+        run(job, n);
+    }
+
+    // Process-wide scheduler, created on first use with all cores.
+    static TaskScheduler& global();
+
+private:
+    struct Job {
+        void (*fn)(void* ctx, std::size_t index, unsigned worker) = nullptr;
+        void* ctx = nullptr;
+        std::size_t grain = 1;
+        std::atomic<std::size_t> pending{0};
+    };
+
+    struct Task {
+        Job*        job;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    // Fixed-capacity deque guarded by a spinlock. The owner only contends
+    // with thieves, which are rare once every worker has work.
+    class TaskDeque {
+    public:
+        static constexpr std::size_t kCapacity = 1024;
+
+        bool pushBottom(const Task& t);
+        bool popBottom(Task& t);
+        bool stealTop(Task& t);
+        bool probablyEmpty() const {
+            return top.load(std::memory_order_relaxed) == bottom.load(std::memory_order_relaxed);
+        }
+
+    private:
+        void lock();
+        void unlock() { busy.store(false, std::memory_order_release); }
+
+        Task tasks[kCapacity];
+        std::atomic<std::size_t> top{0};
+        std::atomic<std::size_t> bottom{0};
+        std::atomic<bool> busy{false};
+    };
+
+    struct alignas(64) Worker {
+        TaskDeque deque;
+        std::thread thread;
+        std::uint64_t rng = 0;
+    };
+
+    template <class Fn>
+    static void invoke(void* ctx, std::size_t index, unsigned worker) {
+        (*static_cast<Fn*>(ctx))(index, worker);
+    }
+
+    void run(Job& job, std::size_t n);
+    void workerLoop(unsigned index);
+    void execute(const Task& t, unsigned worker);
+    bool findTask(unsigned worker, Task& out);
+    bool stealFrom(unsigned thief, Task& out);
+    // some deque or the injection queue looks non-empty
+    bool workVisible() const;
+    void submitExternal(const Task& t);
+    void wake();
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // tasks submitted from threads outside the pool
+    std::mutex injectMutex;
+    std::vector<Task> injected;
+    std::atomic<std::size_t> injectedCount{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+    std::atomic<int> sleepers{0};
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<bool> stopping{false};
+
+    std::mutex waitMutex;
+    std::condition_variable waitCv;
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,182 @@
+#include "Solver.h"
+
+namespace {
+
+// A round needs at least one card played every three turns,
+// so a game with n cards left lasts at most 3n + 2 more turns.
+int maxPlies(int totalCards) {
+    return 3 * totalCards + 3;
+}
+
+// Below this many cards a subtree is cheaper to search again than a table
+// probe (a cache miss) costs.
+constexpr int kMinTableCards = 8;
+
+// table "work" of a result: bit length of the nodes it took
+int workOf(long long n) {
+    int w = 0;
+    while (n > 0) {
+        ++w;
+        n >>= 1;
+    }
+    return w;
+}
+
+} // namespace
+
+EndgameSolver::EndgameSolver(const SolverOptions& o)
+    : opts(), moveStack(), orderer(), nodes(0), ttHits(0), tbHits(0), aborted(false),
+      timed(false), deadline(), stop(nullptr)
+{
+    setOptions(o);
+}
+
+void EndgameSolver::setOptions(const SolverOptions& o) {
+    opts = o;
+    moveStack.resize(static_cast<std::size_t>(maxPlies(opts.maxTotalCards)));
+    orderer.resize(maxPlies(opts.maxTotalCards));
+}
+
+bool EndgameSolver::outOfTime() {
+    // reading the clock is far more expensive than a node: check every 1024
+    if ((nodes & 1023) == 0 &&
+        (stop->stopRequested() || (timed && std::chrono::steady_clock::now() >= deadline))) {
+        aborted = true;
+    }
+    return aborted;
+}
+
+int EndgameSolver::search(GameState& s, int ply, int alpha, int beta) {
+    ++nodes;
+    if (s.isTerminal()) {
+        // the winner keeps the turn, so "side to move" is the winner here
+        return 1;
+    }
+    if (outOfTime() || ply >= static_cast<int>(moveStack.size())) {
+        aborted = true;
+        return 0;
+    }
+
+    if (opts.tablebase && opts.tablebase->covers(s)) {
+        ++tbHits;
+        return opts.tablebase->win(s) ? 1 : -1;
+    }
+    const bool useTable = opts.table && s.totalCards() >= kMinTableCards;
+    TTData hit;
+    if (useTable && opts.table->probe(s.hash(), hit)) {
+        ++ttHits;
+        return hit.value;
+    }
+    const long long startNodes = nodes;
+
+    int me = s.currentPlayer();
+    MoveList& moves = moveStack[static_cast<std::size_t>(ply)];
+    s.legalMoves(moves);
+    if (opts.ordering) {
+        orderer.order(moves, s, ply);
+    }
+
+    int best = -1;
+    for (const Move& mv : moves) {
+        UndoRecord u = s.apply(mv);
+        int next = s.currentPlayer();
+        int v;
+        if (s.sameTeam(me, next)) {
+            v = search(s, ply + 1, alpha, beta);
+        } else {
+            v = -search(s, ply + 1, -beta, -alpha);
+        }
+        s.undo(u);
+
+        if (aborted) {
+            return 0;
+        }
+        if (v > best) {
+            best = v;
+            if (best > alpha) alpha = best;
+            if (alpha >= beta) { // a win: nothing better exists
+                if (opts.ordering) {
+                    orderer.recordCutoff(mv, ply, s.totalCards());
+                }
+                break;
+            }
+        }
+    }
+    if (useTable) {
+        TTData d;
+        d.value = best;
+        d.work  = workOf(nodes - startNodes);
+        opts.table->store(s.hash(), d);
+    }
+    return best;
+}
+
+SolverResult EndgameSolver::solve(const GameState& state, const SearchLimits& limits) {
+    SolverResult r;
+    if (!applies(state)) {
+        return r;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    deadline = limits.capped(start, opts.budgetMs);
+    timed    = opts.budgetMs > 0.0 || limits.hasDeadline();
+    stop     = &limits.stop;
+    nodes   = 0;
+    ttHits  = 0;
+    tbHits  = 0;
+    aborted = false;
+    orderer.clear();
+
+    GameState s = state;
+    int me = s.currentPlayer();
+    MoveList& moves = moveStack[0];
+    s.legalMoves(moves);
+    if (opts.ordering) {
+        orderer.order(moves, s, 0);
+    }
+    r.best = moves[0];
+
+    // a stored loss needs no move; a stored win still has to find one
+    const bool useTable = opts.table && s.totalCards() >= kMinTableCards;
+    TTData hit;
+    if (useTable && opts.table->probe(s.hash(), hit) && hit.value < 0) {
+        r.solved = true;
+        r.ttHits = 1;
+        r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return r;
+    }
+
+    bool allLose = true;
+    for (int i = 0; i < moves.size() && !aborted; ++i) {
+        const Move mv = moves[i];
+        UndoRecord u = s.apply(mv);
+        int next = s.currentPlayer();
+        int v = s.sameTeam(me, next) ? search(s, 1, -1, 1)
+                                     : -search(s, 1, -1, 1);
+        s.undo(u);
+        if (aborted) break;
+
+        if (v > 0) {
+            r.solved = true;
+            r.win    = true;
+            r.best   = mv;
+            allLose  = false;
+            break;
+        }
+    }
+    if (!aborted && allLose) {
+        r.solved = true; // proven loss: every move loses
+    }
+    if (r.solved && useTable) {
+        TTData d;
+        d.value = r.win ? 1 : -1;
+        d.work  = workOf(nodes);
+        opts.table->store(s.hash(), d);
+    }
+
+    r.nodes  = nodes;
+    r.ttHits = ttHits;
+    r.tbHits = tbHits;
+    r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return r;
+}
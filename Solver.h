@@ -0,0 +1,86 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <chrono>
+#include <vector>
+#include "Anytime.h"
+#include "Engine.h"
+#include "MoveOrder.h"
+#include "Tablebase.h"
+#include "TransTable.h"
+
+// =========================
+// Perfect-information endgame solver
+// =========================
+//
+// Exact win/loss alpha-beta over the headless engine, for positions where
+// every hand is known (or assumed known) and few cards are left. Scoring is
+// team-aware: the landlord plays alone against the two peasants, so a move
+// only flips the sign of the value when the turn passes to the other team.
+//
+// Moves come from MoveGenerator, i.e. the same canBeat / analyzeHand rules
+// the game uses. The search gives up when its time budget runs out, at the
+// SearchLimits deadline if that comes first, or when the limits' stop flag
+// is raised; with no budget and no limits the result depends only on the
+// position (reproducible self-play).
+//
+// With a TransTable every proven position is stored under its Zobrist hash
+// and looked up before it is searched again, both within one solve() (move
+// transpositions) and across calls / threads sharing the table. Values are
+// exact, so the table changes node counts, never results. A Tablebase
+// answers every position it covers without searching it.
+//
+// Move lists are sorted by MoveOrderer (immediate wins, killers, history,
+// cards shed) before they are searched; `ordering = false` searches them in
+// generator order, which only costs nodes.
+
+struct SolverOptions {
+    int    maxTotalCards = 15;  // only solve when all hands together hold <= this
+    double budgetMs      = 1.0; // wall-clock budget per solve() call, <= 0: none
+    TransTable* table    = nullptr; // shared proven positions, may be null
+    const Tablebase* tablebase = nullptr; // exact small endgames, may be null
+    bool   ordering      = true; // sort moves with MoveOrderer
+};
+
+struct SolverResult {
+    bool   solved = false;   // false: over budget / too many cards
+    bool   win    = false;   // side to move (its team) wins with `best`
+    Move   best;             // a winning move if win, else any legal move
+    long long nodes  = 0;
+    long long ttHits = 0;    // positions answered by the transposition table
+    long long tbHits = 0;    // positions answered by the tablebase
+    double ms        = 0.0;
+};
+
+class EndgameSolver {
+public:
+    explicit EndgameSolver(const SolverOptions& opts = SolverOptions());
+
+    const SolverOptions& options() const { return opts; }
+    void setOptions(const SolverOptions& o);
+
+    // Is `state` small enough for this solver to try?
+    bool applies(const GameState& state) const {
+        return !state.isTerminal() && state.totalCards() <= opts.maxTotalCards;
+    }
+
+    SolverResult solve(const GameState& state, const SearchLimits& limits = SearchLimits());
+
+private:
+    // +1: the team of the player to move in `s` wins, -1: it loses
+    int search(GameState& s, int ply, int alpha, int beta);
+    bool outOfTime();
+
+    SolverOptions opts;
+    std::vector<MoveList> moveStack; // one list per ply, allocated once
+    MoveOrderer orderer;
+    long long nodes;
+    long long ttHits;
+    long long tbHits;
+    bool aborted;
+    bool timed;                     // a deadline applies to this solve
+    std::chrono::steady_clock::time_point deadline;
+    const StopToken* stop;          // the current solve's limits.stop
+};
+
+#endif // SOLVER_H
@@ -0,0 +1,422 @@
+#include "Tablebase.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "Canonical.h"
+#include "MoveGen.h"
+#include "Scheduler.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int kRankSlots = 15; // nibbles of a RankCounts word
+
+constexpr int capOf(int slot) { return slot < 13 ? 4 : 1; } // jokers: one card each
+
+// 64 bytes, little-endian fields (the table is not meant to travel between
+// machines of different byte order)
+struct FileHeader {
+    char          magic[8];    // "DDZTB\0\0\0"
+    std::uint32_t version;
+    std::uint32_t k;
+    std::uint64_t entries;
+    std::uint64_t hands;
+    std::uint32_t tableStates;
+    std::uint32_t headerBytes;
+    std::uint8_t  reserved[24];
+};
+static_assert(sizeof(FileHeader) == 64, "tablebase header must stay 64 bytes");
+
+constexpr char kMagic[8] = { 'D', 'D', 'Z', 'T', 'B', 0, 0, 0 };
+constexpr std::uint32_t kVersion = 1;
+
+std::uint64_t wordsFor(std::uint64_t entries) {
+    return (entries + 63) / 64;
+}
+
+} // namespace
+
+// ======================
+// Layout: hand ranking and table classes for one K
+// ======================
+
+struct Tablebase::Layout {
+    int k = 0;
+    // ways[i][s]: histograms of slots i..14 with at most s cards
+    std::uint64_t ways[kRankSlots + 1][kMaxK + 1] = {};
+    std::vector<std::uint64_t> words;       // hand index -> RankCounts word
+    std::vector<int>           sizes;       // hand index -> cards
+    std::vector<int>           bySize[kMaxK + 1];
+    std::vector<Move>          classes;     // table class c (1-based) -> representative
+
+    explicit Layout(int kk) : k(kk) {
+        for (int s = 0; s <= k; ++s) {
+            ways[kRankSlots][s] = 1;
+        }
+        for (int i = kRankSlots - 1; i >= 0; --i) {
+            for (int s = 0; s <= k; ++s) {
+                for (int c = 0; c <= capOf(i) && c <= s; ++c) {
+                    ways[i][s] += ways[i + 1][s - c];
+                }
+            }
+        }
+        enumerate(0, k, 0);
+
+        for (int r = 3; r <= 17; ++r) {
+            classes.push_back(Move(HandType::Single, CardSet::ofRank(r).takeOfRank(r, 1), r));
+        }
+        for (int r = 3; r <= 15; ++r) {
+            classes.push_back(Move(HandType::Pair, CardSet::ofRank(r).takeOfRank(r, 2), r));
+        }
+        if (k >= 4) {
+            for (int r = 3; r <= 15; ++r) {
+                classes.push_back(Move(HandType::Bomb, CardSet::ofRank(r), r));
+            }
+        }
+        CardSet straight;
+        for (int r = 3; r <= 7; ++r) {
+            straight |= CardSet::ofRank(r).takeOfRank(r, 1);
+        }
+        classes.push_back(Move(HandType::Straight, straight, 7)); // "big": bombs / rocket only
+        classes.push_back(Move(HandType::Rocket, CardSet::ofRank(16) | CardSet::ofRank(17), 100));
+    }
+
+    // same order as rank(): slot 0 most significant, counts ascending
+    void enumerate(int slot, int left, std::uint64_t w) {
+        if (slot == kRankSlots) {
+            words.push_back(w);
+            int n = RankCounts(w).total();
+            sizes.push_back(n);
+            bySize[n].push_back(static_cast<int>(words.size() - 1));
+            return;
+        }
+        for (int c = 0; c <= capOf(slot) && c <= left; ++c) {
+            enumerate(slot + 1, left - c, w + (static_cast<std::uint64_t>(c) << (4 * slot)));
+        }
+    }
+
+    int handCount() const { return static_cast<int>(words.size()); }
+    int tableStates() const { return 2 * static_cast<int>(classes.size()) + 1; }
+
+    // hand index of a histogram with <= k cards
+    int rank(std::uint64_t w) const {
+        std::uint64_t idx = 0;
+        int left = k;
+        for (int i = 0; i < kRankSlots; ++i) {
+            int c = static_cast<int>((w >> (4 * i)) & 0xF);
+            for (int v = 0; v < c; ++v) {
+                idx += ways[i + 1][left - v];
+            }
+            left -= c;
+        }
+        return static_cast<int>(idx);
+    }
+
+    // table class (1-based) of a played move
+    int classOf(const Move& mv) const {
+        const int big = static_cast<int>(classes.size()) - 1;
+        switch (mv.type) {
+        case HandType::Single: return 1 + (mv.mainRank - 3);
+        case HandType::Pair:   return 16 + (mv.mainRank - 3);
+        case HandType::Bomb:   return k >= 4 ? 29 + (mv.mainRank - 3) : big;
+        case HandType::Rocket: return big + 1;
+        default:               return big; // straight / full house
+        }
+    }
+
+    // table state with no pass yet after `mv`
+    int tableStateOf(const Move& mv) const { return 2 * classOf(mv) - 1; }
+};
+
+// ======================
+// Tablebase
+// ======================
+
+Tablebase::Tablebase()
+    : k(0), entries(0), layout(), bits(nullptr), built(), copied(),
+      mapped(nullptr), mappedBytes(0) {}
+
+Tablebase::~Tablebase() {
+    close();
+}
+
+void Tablebase::close() {
+#if !defined(_WIN32)
+    if (mapped) {
+        munmap(mapped, mappedBytes);
+    }
+#endif
+    mapped = nullptr;
+    mappedBytes = 0;
+    bits = nullptr;
+    built.reset();
+    copied.clear();
+    copied.shrink_to_fit();
+    layout.reset();
+    k = 0;
+    entries = 0;
+}
+
+void Tablebase::setGeometry(int kk) {
+    layout = std::make_shared<Layout>(kk);
+    k = kk;
+    std::uint64_t h = static_cast<std::uint64_t>(layout->handCount());
+    entries = 3 * static_cast<std::uint64_t>(layout->tableStates()) * h * h * h;
+}
+
+std::uint64_t Tablebase::fileBytes(int kk) {
+    if (kk < 1 || kk > kMaxK) {
+        return 0;
+    }
+    Layout l(kk);
+    std::uint64_t h = static_cast<std::uint64_t>(l.handCount());
+    return sizeof(FileHeader) + 8 * wordsFor(3 * static_cast<std::uint64_t>(l.tableStates()) * h * h * h);
+}
+
+std::uint64_t Tablebase::index(int lordRel, int tableState, int h0, int h1, int h2) const {
+    const std::uint64_t h = static_cast<std::uint64_t>(layout->handCount());
+    return (((static_cast<std::uint64_t>(lordRel) * layout->tableStates() + tableState)
+             * h + h0) * h + h1) * h + h2;
+}
+
+// Seat 0 to move, landlord at relative seat `lordRel`. While building,
+// children are read from the layers already solved.
+bool Tablebase::solvePosition(int lordRel, int tableState, int h0, int h1, int h2,
+                              MoveList& moves) const {
+    const Layout& l = *layout;
+    const std::uint64_t w0 = l.words[static_cast<std::size_t>(h0)];
+    const bool   onePass  = tableState != 0 && tableState % 2 == 0;
+    const Move   table    = tableState == 0 ? Move() : l.classes[static_cast<std::size_t>((tableState + 1) / 2 - 1)];
+    const bool   partnerNext = (lordRel == 2);   // seats 0 and 1 both peasants
+    const int    childLord   = (lordRel + 2) % 3;
+
+    auto childBit = [&](std::uint64_t i) {
+        return built ? ((built[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) & 1u) != 0
+                     : bit(i);
+    };
+
+    MoveGenerator::generate(lowestSuits(RankCounts(w0)), table, moves);
+    for (const Move& mv : moves) {
+        bool childWin;
+        if (mv.isPass()) {
+            // one pass more, or the second pass clears the table; either
+            // way seat 1 moves next with the same hands
+            childWin = childBit(index(childLord, onePass ? 0 : tableState + 1, h1, h2, h0));
+        } else {
+            std::uint64_t rest = w0 - RankCounts::of(mv.cardSet).word();
+            if (rest == 0) {
+                return true;
+            }
+            childWin = childBit(index(childLord, l.tableStateOf(mv), h1, h2, l.rank(rest)));
+        }
+        if (childWin == partnerNext) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Tablebase::build(int kk, TaskScheduler& scheduler) {
+    if (kk < 1 || kk > kMaxK) {
+        throw std::invalid_argument("Tablebase::build: k must be 1..4");
+    }
+    close();
+    setGeometry(kk);
+    const Layout& l = *layout;
+    const std::uint64_t words = wordsFor(entries);
+    built.reset(new std::atomic<std::uint64_t>[words]);
+    for (std::uint64_t w = 0; w < words; ++w) {
+        built[w].store(0, std::memory_order_relaxed);
+    }
+
+    // table states by pass count
+    std::vector<int> onePass, noPass;
+    for (int ts = 1; ts < l.tableStates(); ++ts) {
+        (ts % 2 == 0 ? onePass : noPass).push_back(ts);
+    }
+    const std::vector<int> cleared = { 0 };
+    const std::vector<int>* phases[3] = { &cleared, &onePass, &noPass };
+
+    // no rank may hold more cards than exist
+    auto fits = [](std::uint64_t w) {
+        return ((w + 0x0663333333333333ull) & RankCounts::kHighs) == 0;
+    };
+
+    std::vector<std::uint64_t> triples; // h0 | h1 << 21 | h2 << 42
+    for (int n = 3; n <= 3 * k; ++n) {
+        triples.clear();
+        for (int s0 = 1; s0 <= k; ++s0) {
+            for (int s1 = 1; s1 <= k; ++s1) {
+                int s2 = n - s0 - s1;
+                if (s2 < 1 || s2 > k) continue;
+                for (int a : l.bySize[s0]) {
+                    for (int b : l.bySize[s1]) {
+                        std::uint64_t ab = l.words[static_cast<std::size_t>(a)] + l.words[static_cast<std::size_t>(b)];
+                        if (!fits(ab)) continue;
+                        for (int c : l.bySize[s2]) {
+                            if (fits(ab + l.words[static_cast<std::size_t>(c)])) {
+                                triples.push_back(static_cast<std::uint64_t>(a) |
+                                                  static_cast<std::uint64_t>(b) << 21 |
+                                                  static_cast<std::uint64_t>(c) << 42);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        for (const std::vector<int>* states : phases) {
+            scheduler.parallelFor(triples.size(), 256, [&](std::size_t t, unsigned) {
+                MoveList moves;
+                const std::uint64_t p = triples[t];
+                const int h0 = static_cast<int>(p & 0x1FFFFF);
+                const int h1 = static_cast<int>((p >> 21) & 0x1FFFFF);
+                const int h2 = static_cast<int>(p >> 42);
+                for (int lord = 0; lord < 3; ++lord) {
+                    for (int ts : *states) {
+                        if (solvePosition(lord, ts, h0, h1, h2, moves)) {
+                            std::uint64_t i = index(lord, ts, h0, h1, h2);
+                            built[i >> 6].fetch_or(std::uint64_t{1} << (i & 63),
+                                                   std::memory_order_relaxed);
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+    // done: plain words from here on
+    copied.resize(static_cast<std::size_t>(words));
+    for (std::uint64_t w = 0; w < words; ++w) {
+        copied[static_cast<std::size_t>(w)] = built[w].load(std::memory_order_relaxed);
+    }
+    built.reset();
+    bits = copied.data();
+}
+
+bool Tablebase::save(const std::string& path) const {
+    if (!loaded()) {
+        return false;
+    }
+    FileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version     = kVersion;
+    h.k           = static_cast<std::uint32_t>(k);
+    h.entries     = entries;
+    h.hands       = static_cast<std::uint64_t>(layout->handCount());
+    h.tableStates = static_cast<std::uint32_t>(layout->tableStates());
+    h.headerBytes = sizeof(FileHeader);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(bits),
+              static_cast<std::streamsize>(8 * wordsFor(entries)));
+    return static_cast<bool>(out);
+}
+
+bool Tablebase::open(const std::string& path) {
+    close();
+
+    FileHeader h;
+    std::ifstream in(path, std::ios::binary);
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) ||
+        std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 ||
+        h.version != kVersion || h.k < 1 || h.k > static_cast<std::uint32_t>(kMaxK) ||
+        h.headerBytes != sizeof(FileHeader)) {
+        return false;
+    }
+    setGeometry(static_cast<int>(h.k));
+    if (h.entries != entries ||
+        h.hands != static_cast<std::uint64_t>(layout->handCount()) ||
+        h.tableStates != static_cast<std::uint32_t>(layout->tableStates())) {
+        close();
+        return false;
+    }
+    const std::uint64_t dataBytes = 8 * wordsFor(entries);
+
+#if defined(_WIN32)
+    copied.resize(static_cast<std::size_t>(dataBytes / 8));
+    if (!in.read(reinterpret_cast<char*>(copied.data()), static_cast<std::streamsize>(dataBytes))) {
+        close();
+        return false;
+    }
+    bits = copied.data();
+#else
+    in.close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        close();
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<std::uint64_t>(st.st_size) < sizeof(FileHeader) + dataBytes) {
+        ::close(fd);
+        close();
+        return false;
+    }
+    mappedBytes = static_cast<std::size_t>(sizeof(FileHeader) + dataBytes);
+    void* p = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file
+    if (p == MAP_FAILED) {
+        mappedBytes = 0;
+        close();
+        return false;
+    }
+    mapped = p;
+    bits = reinterpret_cast<const std::uint64_t*>(static_cast<const char*>(p) + sizeof(FileHeader));
+#endif
+    return true;
+}
+
+bool Tablebase::covers(const GameState& s) const {
+    if (!loaded() || s.isTerminal()) {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i) {
+        int n = s.handSize(i);
+        if (n < 1 || n > k) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Tablebase::win(const GameState& s) const {
+    const Layout& l = *layout;
+    const int me = s.currentPlayer();
+    const int lordRel = (s.landlord() - me + 3) % 3;
+    const Move& t = s.lastMove();
+    const int ts = t.isPass() ? 0 : l.tableStateOf(t) + s.passCount();
+    int h[3];
+    for (int j = 0; j < 3; ++j) {
+        h[j] = l.rank(RankCounts::of(s.hand((me + j) % 3)).word());
+    }
+    return bit(index(lordRel, ts, h[0], h[1], h[2]));
+}
+
+bool Tablebase::bestMove(const GameState& s, Move& out) const {
+    MoveList moves;
+    s.legalMoves(moves);
+    out = moves[0];
+    const int me = s.currentPlayer();
+    for (const Move& mv : moves) {
+        GameState c = s;
+        c.apply(mv);
+        bool mine = c.isTerminal() ||
+                    (s.sameTeam(me, c.currentPlayer()) ? win(c) : !win(c));
+        if (mine) {
+            out = mv;
+            return true;
+        }
+    }
+    return false;
+}
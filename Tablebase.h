@@ -0,0 +1,100 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Engine.h"
+
+class TaskScheduler;
+
+// =========================
+// Endgame tablebase (retrograde, memory-mapped)
+// =========================
+//
+// Exact win/loss for every position in which all three hands hold 1..K
+// cards, one bit each. Suits never matter, so a hand is just its rank
+// histogram (the suit-canonical form, see Canonical.h); seats are taken
+// relative to the player to move, so one entry serves all three rotations.
+//
+// A position is (landlord seat, table state, hand 0, hand 1, hand 2) with
+// seat 0 the player to move. The table state is empty, or the table move's
+// class plus the pass count (0 / 1). With K <= 4 no hand can form a
+// straight or a full house, so those collapse into one class "only bombs /
+// the rocket beat it" (with K < 4 bombs join it too).
+//
+// build() works backwards from the positions with the fewest cards: a play
+// always leads to fewer cards, and at the same cards a table with one pass
+// only depends on the cleared table, a table with no pass only on one pass.
+// Each of those layers is solved in parallel on a TaskScheduler.
+//
+// The file is a 64-byte header plus the bit array; open() maps it
+// read-only (shared by every process on the host) and a probe is one
+// histogram ranking per hand plus one bit read.
+//
+// Size grows fast with K: K = 1 is 94 KB, K = 2 about 53 MB, K = 3 about
+// 10 GB.
+
+class Tablebase {
+public:
+    static constexpr int kMaxK = 4;
+    static constexpr const char* kDefaultFile = "doudizhu.tb";
+
+    Tablebase();
+    ~Tablebase();
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+
+    // Bytes build(k) would need / save() writes (header included).
+    static std::uint64_t fileBytes(int k);
+
+    // Solve every position with 1..k cards per hand (k in 1..kMaxK, throws
+    // std::invalid_argument otherwise). Replaces whatever was loaded.
+    void build(int k, TaskScheduler& scheduler);
+    // Write the built table; false on I/O errors.
+    bool save(const std::string& path) const;
+
+    // Map a file written by save(); false (and nothing loaded) when it is
+    // missing or not a tablebase.
+    bool open(const std::string& path);
+    void close();
+
+    bool loaded() const { return bits != nullptr; }
+    int  maxCards() const { return k; }
+    std::uint64_t positions() const { return entries; }
+
+    // Is `s` in the table: game running, every hand 1..K cards?
+    bool covers(const GameState& s) const;
+    // Does the team of the player to move win? Requires covers(s).
+    bool win(const GameState& s) const;
+    // A winning move if there is one (returns true), else the first legal
+    // move (returns false). One probe per legal move, no search.
+    // Requires covers(s).
+    bool bestMove(const GameState& s, Move& out) const;
+
+private:
+    struct Layout;
+
+    std::uint64_t index(int lordRel, int tableState, int h0, int h1, int h2) const;
+    bool bit(std::uint64_t i) const {
+        return (bits[i >> 6] >> (i & 63)) & 1u;
+    }
+    void setGeometry(int k);
+    bool solvePosition(int lordRel, int tableState, int h0, int h1, int h2,
+                       MoveList& moves) const;
+
+    int k;
+    std::uint64_t entries;
+    std::shared_ptr<const Layout> layout;   // hand ranking / table classes for k
+
+    const std::uint64_t* bits;              // into `built` or the mapping
+    std::unique_ptr<std::atomic<std::uint64_t>[]> built;
+    std::vector<std::uint64_t> copied;      // no mmap (Windows): file read into memory
+    void*       mapped;
+    std::size_t mappedBytes;
+};
+
+#endif // TABLEBASE_H
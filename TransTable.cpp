@@ -0,0 +1,110 @@
+#include "TransTable.h"
+
+// data word: value + 128 (8 bits) | work (6 bits) << 8 | generation (8 bits) << 16
+// | a "used" bit, so a stored entry is never 0
+namespace {
+
+constexpr std::uint64_t kUsed = std::uint64_t{1} << 24;
+
+int valueOf(std::uint64_t d)       { return static_cast<int>(d & 0xFF) - 128; }
+int workOf(std::uint64_t d)        { return static_cast<int>((d >> 8) & 0x3F); }
+unsigned generationOf(std::uint64_t d) { return static_cast<unsigned>((d >> 16) & 0xFF); }
+
+} // namespace
+
+TransTable::TransTable(std::size_t megabytes)
+    : buckets(), bucketCount(0), mask(0), generation(0)
+{
+    resize(megabytes);
+}
+
+void TransTable::resize(std::size_t megabytes) {
+    std::size_t want = megabytes * 1024 * 1024 / sizeof(Bucket);
+    std::size_t n = 1;
+    while (n * 2 <= want) {
+        n *= 2;
+    }
+    buckets.reset(new Bucket[n]);
+    bucketCount = n;
+    mask = n - 1;
+    clear();
+}
+
+void TransTable::clear() {
+    for (std::size_t b = 0; b < bucketCount; ++b) {
+        for (Entry& e : buckets[b].e) {
+            e.check.store(0, std::memory_order_relaxed);
+            e.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation.store(0, std::memory_order_relaxed);
+}
+
+void TransTable::newSearch() {
+    generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t TransTable::pack(const TTData& d, unsigned gen) {
+    int v = d.value < -128 ? -128 : (d.value > 127 ? 127 : d.value);
+    int w = d.work < 0 ? 0 : (d.work > 63 ? 63 : d.work);
+    return static_cast<std::uint64_t>(v + 128) |
+           static_cast<std::uint64_t>(w) << 8 |
+           static_cast<std::uint64_t>(gen & 0xFF) << 16 |
+           kUsed;
+}
+
+bool TransTable::probe(std::uint64_t key, TTData& out) const {
+    const Bucket& b = buckets[key & mask];
+    for (const Entry& e : b.e) {
+        std::uint64_t d = e.data.load(std::memory_order_relaxed);
+        if (d != 0 && (e.check.load(std::memory_order_relaxed) ^ d) == key) {
+            out.value = valueOf(d);
+            out.work  = workOf(d);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TransTable::store(std::uint64_t key, const TTData& d) {
+    Bucket& b = buckets[key & mask];
+    const unsigned gen = generation.load(std::memory_order_relaxed);
+
+    // same key, else empty, else least work (each generation of age
+    // counts as 4 less work)
+    Entry* victim = nullptr;
+    int victimScore = 1 << 30;
+    for (Entry& e : b.e) {
+        std::uint64_t old = e.data.load(std::memory_order_relaxed);
+        if (old == 0 || (e.check.load(std::memory_order_relaxed) ^ old) == key) {
+            victim = &e;
+            break;
+        }
+        int age = static_cast<int>((gen - generationOf(old)) & 0xFF);
+        int score = workOf(old) - 4 * age;
+        if (score < victimScore) {
+            victimScore = score;
+            victim = &e;
+        }
+    }
+
+    std::uint64_t data = pack(d, gen);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+    victim->data.store(data, std::memory_order_relaxed);
+}
+
+int TransTable::usagePermille() const {
+    const unsigned gen = generation.load(std::memory_order_relaxed) & 0xFF;
+    int used = 0;
+    int seen = 0;
+    for (std::size_t b = 0; b < bucketCount && seen < 1000; ++b) {
+        for (const Entry& e : buckets[b].e) {
+            std::uint64_t d = e.data.load(std::memory_order_relaxed);
+            if (d != 0 && generationOf(d) == gen) {
+                ++used;
+            }
+            ++seen;
+        }
+    }
+    return seen > 0 ? used * 1000 / seen : 0;
+}
@@ -0,0 +1,76 @@
+#ifndef TRANSTABLE_H
+#define TRANSTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// =========================
+// Shared transposition table
+// =========================
+//
+// Fixed-size hash table of solved positions, keyed by GameState::hash().
+// Any number of search threads probe and store at the same time without
+// locks: every entry is two 64-bit words, (key ^ data, data), written and
+// read with relaxed atomics. A reader only accepts an entry whose words
+// XOR back to its key, so an entry torn by two racing writers reads as a
+// miss instead of a wrong value.
+//
+// Entries sit in 64-byte buckets of four (one cache line per probe). A
+// store overwrites the same key if present, else an empty slot, else the
+// slot worth least: little work behind it, and older searches (see
+// newSearch()) count as less work.
+//
+// Only exact results go in, so a hit never depends on which thread or game
+// stored it: searches that use the table return the same values with or
+// without it, just faster.
+
+struct TTData {
+    int value = 0; // -128..127, meaning chosen by the caller
+    int work  = 0; // 0..63, e.g. log2 of the nodes searched for `value`
+};
+
+class TransTable {
+public:
+    // `megabytes` is rounded down to a power-of-two number of buckets
+    // (at least one). Throws std::bad_alloc if it cannot be allocated.
+    explicit TransTable(std::size_t megabytes = 16);
+
+    // Reallocate (and clear). Not safe while other threads use the table.
+    void resize(std::size_t megabytes);
+    // Forget everything. Not safe while other threads use the table.
+    void clear();
+
+    // Start a new search generation: entries stored before now are
+    // replaced first. Safe to call from any thread.
+    void newSearch();
+
+    bool probe(std::uint64_t key, TTData& out) const;
+    void store(std::uint64_t key, const TTData& d);
+
+    std::size_t bytes() const { return bucketCount * sizeof(Bucket); }
+    std::size_t capacity() const { return bucketCount * kWays; }
+    // slots in use out of a 1000-slot sample, current generation only
+    int usagePermille() const;
+
+private:
+    static constexpr int kWays = 4;
+
+    struct Entry {
+        std::atomic<std::uint64_t> check; // key ^ data
+        std::atomic<std::uint64_t> data;  // 0: empty
+    };
+    struct alignas(64) Bucket {
+        Entry e[kWays];
+    };
+
+    static std::uint64_t pack(const TTData& d, unsigned generation);
+
+    std::unique_ptr<Bucket[]> buckets;
+    std::size_t bucketCount;
+    std::uint64_t mask;
+    std::atomic<unsigned> generation;
+};
+
+#endif // TRANSTABLE_H
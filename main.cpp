@@ -1,13 +1,49 @@
+#include <cctype>
 #include <iostream>
+#include <string>
 #include "Game.h"
 
-int main() {
+namespace {
+
+void usage() {
+    std::cerr << "usage: game [--seed N | --self-check]\n"
+                 "  --seed N      replay a deal (N from game_log.txt, 0..2^64-1)\n"
+                 "  --self-check  check the hand classifier and exit\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
     std::ios::sync_with_stdio(false);
     std::cin.tie(nullptr);
 
+    // ./game --self-check : differential check of the hand classifier
+    if (argc > 1 && std::string(argv[1]) == "--self-check") {
+        return checkAnalyzeHand(std::cout) == 0 ? 0 : 1;
+    }
+
+    // ./game --seed N : replay a specific deal (the seed is written to game_log.txt)
+    std::uint64_t seed = randomDealSeed();
+    if (argc > 2 && std::string(argv[1]) == "--seed") {
+        // stoull throws on junk / overflow; it also skips blanks, takes a sign
+        // and stops at a tail, so the whole argument must be digits
+        const std::string v = argv[2];
+        std::size_t used = 0;
+        try {
+            seed = std::stoull(v, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used == 0 || used != v.size() ||
+            !std::isdigit(static_cast<unsigned char>(v[0]))) {
+            usage();
+            return 1;
+        }
+    }
+
     try {
         Game game;
-        game.initGame();
+        game.initGame(seed);
         game.play();
     } catch (const std::exception& e) {
         std::cerr << "Exception: " << e.what() << "\n";
@@ -6,11 +6,16 @@
 #include <string>
 #include <iostream>
 #include <algorithm>
-#include <random>
 
+#include "AiWorker.h"
+#include "Bidding.h"
 #include "Card.h"
 #include "Character.h"
+#include "Scheduler.h"
 #include "Deck.h"
+#include "Engine.h"
+#include "Tablebase.h"
+#include "TransTable.h"
 
 // ======================
 // Layout constants
@@ -22,35 +27,40 @@ constexpr float CARD_GAP_MAX = 10.f;
 constexpr float HUMAN_Y      = 520.f;
 constexpr float SIDE_MARGIN  = 40.f;
 
+// AI 的一手至少在畫面上「思考」這麼久（秒），這段時間也就是它的搜尋期限；
+// 超過期限再 AI_GRACE 秒還沒回來就不等了：直接出它目前最好的一手（bestSoFar），
+// 搜尋丟給背景執行緒自己收尾
+constexpr float AI_MIN_SHOW  = 0.8f;
+constexpr float AI_GRACE     = 0.1f;
+// 輪到你時，下一家 AI 用你的時間先想（ponder），最多這麼久（秒）
+constexpr float AI_PONDER_MAX = 5.f;
+
 // ======================
 // Game state container
 // ======================
 
 struct GuiGameState {
-    Deck  deck;
     Player human;
     Enemy  ai1;
     Enemy  ai2;
 
     std::vector<CardCharacter*> players;   // [0] human, [1] ai1, [2] ai2
 
-    std::vector<Card> bottomCards;
+    CardSet bottomCards;
 
-    int landlordIndex        = 0;
-    int currentPlayerIndex   = 0;
+    Deal deal;
+    GameState engine;               // rules: turn, table move, passes, winner
+    CardTracker tracker;            // public info for the AI's hand sampling
 
-    Move lastMove;                  // last non-cleared move (for rules)
-    int  lastMovePlayerIndex = -1;
-    int  passCountInRound    = 0;
+    // AI 讀的是這兩份拷貝（送出請求前由 refreshAiView 更新），
+    // 所以 AI 還在背景收尾時，engine / tracker 照樣可以往下走
+    GameState aiView;
+    CardTracker aiTracker;
 
     Move lastAction[3];             // last action (including Pass) per player
 
-    bool gameOver       = false;
-    int  winnerIndex    = -1;
-
     bool landlordChosen = false;
 
-    int  initialHandSize[3] = {17, 17, 17}; // reset after landlord chosen
     std::string playerNames[3] = {"You", "AI_1", "AI_2"};
 
     GuiGameState()
@@ -71,8 +81,6 @@ std::string getPlayerName(const GuiGameState& g, int idx) {
     return g.playerNames[idx];
 }
 
-int nextIndex(int idx) { return (idx + 1) % 3; }
-
 // ======================
 // Card layout helpers
 // ======================
@@ -109,45 +117,65 @@ CardLayout computeCardLayout(std::size_t count, float windowWidth) {
 // Game init / reset / applyMove
 // ======================
 
-void initGuiGame(GuiGameState& g) {
-    g.deck.init();
-    g.deck.shuffle();
+void initGuiGame(GuiGameState& g, std::uint64_t seed) {
+    g.deal = dealCards(seed);
+    Deal& deal = g.deal;
+    std::cout << "Deal seed: " << seed << "\n";
 
     // 發 17 張牌給每個玩家
-    for (int i = 0; i < 17; ++i) {
-        for (int p = 0; p < 3; ++p) {
-            g.players[p]->addCard(g.deck.draw());
-        }
+    for (int p = 0; p < 3; ++p) {
+        g.players[p]->addCards(deal.hands[p]);
+        g.players[p]->sortHand();
     }
 
     // 3 張底牌
-    g.bottomCards.clear();
-    while (g.deck.size() > 0) {
-        g.bottomCards.push_back(g.deck.draw());
-    }
+    g.bottomCards = deal.bottom;
 
-    for (auto* p : g.players) {
-        p->sortHand();
-    }
-
-    g.landlordIndex        = 0;
-    g.currentPlayerIndex   = 0;
-    g.lastMove             = Move();
-    g.lastMovePlayerIndex  = -1;
-    g.passCountInRound     = 0;
-    g.gameOver             = false;
-    g.winnerIndex          = -1;
+    g.engine               = GameState();
     g.landlordChosen       = false;
 
+    // AI 搜尋讀 g.aiView；resetFullGame 會整個 struct 重新指派，所以每局重新接上
+    g.ai1.attachState(&g.aiView);
+    g.ai2.attachState(&g.aiView);
+    g.ai1.attachTracker(&g.aiTracker);
+    g.ai2.attachTracker(&g.aiTracker);
+    g.ai1.setStrategy(AiStrategy::Ismcts);
+    g.ai2.setStrategy(AiStrategy::Ismcts);
+
+    // 用所有核心思考：每個執行緒一棵樹，最後合併根節點的拜訪次數
+    MctsOptions mo;
+    mo.threads  = static_cast<int>(TaskScheduler::global().threadCount());
+    mo.parallel = MctsParallel::Root;
+    g.ai1.setSearchOptions(mo);
+    g.ai2.setSearchOptions(mo);
+
+    // 殘局搜尋共用一張置換表（不放在 GuiGameState 裡：整個 struct 會被重新指派）
+    static TransTable table(16);
+    g.ai1.setTranspositionTable(&table);
+    g.ai2.setTranspositionTable(&table);
+
+    // 有 doudizhu.tb（doudizhu_tablebase 產生）就 mmap 進來，殘局直接查表
+    static Tablebase tablebase;
+    static bool tablebaseTried = false;
+    if (!tablebaseTried) {
+        tablebaseTried = true;
+        if (tablebase.open(Tablebase::kDefaultFile)) {
+            std::cout << "tablebase: " << Tablebase::kDefaultFile << " (K = "
+                      << tablebase.maxCards() << ")\n";
+        }
+    }
+    const Tablebase* tb = tablebase.loaded() ? &tablebase : nullptr;
+    g.ai1.attachTablebase(tb);
+    g.ai2.attachTablebase(tb);
+
     for (int i = 0; i < 3; ++i) {
-        g.lastAction[i]      = Move();
-        g.initialHandSize[i] = 17;
+        g.lastAction[i] = Move();
     }
 }
 
 // 正確的重新開始：重設整個 struct，然後重新綁定 players 指標，再重新發牌
 void resetFullGame(GuiGameState& g) {
-    g = GuiGameState();          // 重新建構裡面的 deck/human/ai1/ai2/flags
+    g = GuiGameState();          // 重新建構裡面的 human/ai1/ai2/flags
 
     // assignment 之後 players 會指向暫時物件，要重新指到 g 自己的成員
     g.players.clear();
@@ -156,7 +184,7 @@ void resetFullGame(GuiGameState& g) {
     g.players.push_back(&g.ai2);
 
     // 再重新發牌 & 初始化狀態
-    initGuiGame(g);
+    initGuiGame(g, randomDealSeed());
 }
 
 // ======================
@@ -167,28 +195,37 @@ void applyMove(GuiGameState& g, int playerIdx, const Move& mv) {
     // 記錄該玩家最後一次動作（給 UI 顯示用）
     g.lastAction[playerIdx] = mv;
 
-    if (mv.isPass()) {
-        if (g.lastMove.type != HandType::Pass) {
-            g.passCountInRound++;
-            if (g.passCountInRound >= 2) {
-                // 兩人連續 Pass，清桌
-                g.lastMove            = Move();
-                g.lastMovePlayerIndex = -1;
-                g.passCountInRound    = 0;
-            }
-        }
-    } else {
-        g.lastMove            = mv;
-        g.lastMovePlayerIndex = playerIdx;
-        g.passCountInRound    = 0;
-    }
+    // 記牌器要看「出牌前」的桌面（誰 Pass 了誰的牌）
+    g.tracker.observe(g.engine, mv);
 
-    if (g.players[playerIdx]->isHandEmpty()) {
-        g.gameOver    = true;
-        g.winnerIndex = playerIdx;
-    } else {
-        g.currentPlayerIndex = nextIndex(playerIdx);
+    // 規則（Pass / 清桌 / 勝負）都交給 engine
+    g.engine.apply(mv);
+}
+
+// 送請求給 AI 之前：把目前的局面拷給它讀（背景沒有請求在跑時才能呼叫）
+void refreshAiView(GuiGameState& g) {
+    g.aiView    = g.engine;
+    g.aiTracker = g.tracker;
+}
+
+// 最後的退路：AI 連貪心的答案都還沒放（執行緒根本還沒排到）。
+// 跟牌就 Pass；領出就出第一個合法的牌型（最小的單張）
+Move fallbackMove(const GameState& s) {
+    if (s.lastMove().type != HandType::Pass) {
+        return Move();
     }
+    MoveList moves;
+    s.legalMoves(moves);
+    return moves.empty() ? Move() : moves[0];
+}
+
+// 選好地主之後：底牌給地主，engine 開局（地主先出）
+void startRound(GuiGameState& g, int landlord) {
+    g.players[landlord]->addCards(g.bottomCards);
+    g.players[landlord]->sortHand();
+    g.engine.start(g.deal, landlord);
+    g.tracker.start(g.bottomCards, landlord);
+    g.landlordChosen = true;
 }
 
 // ======================
@@ -260,8 +297,8 @@ void drawAIPanels(sf::RenderWindow& window,
 
         std::string s = getPlayerName(g, i) +
                         "   Cards: " +
-                        std::to_string(g.players[i]->handSize());
-        if (i == g.landlordIndex) {
+                        std::to_string(g.engine.hand(i).size());
+        if (i == g.engine.landlord()) {
             s += "   (Landlord)";
         }
         t.setString(s);
@@ -367,11 +404,11 @@ void drawHUD(sf::RenderWindow& window,
     info.setFillColor(sf::Color::Yellow);
     info.setPosition({50.f, 110.f});
 
-    if (!g.gameOver) {
-        info.setString("Turn: " + getPlayerName(g, g.currentPlayerIndex));
+    if (!g.engine.isTerminal()) {
+        info.setString("Turn: " + getPlayerName(g, g.engine.currentPlayer()));
     } else {
         info.setString("Game over! Winner: " +
-                       getPlayerName(g, g.winnerIndex));
+                       getPlayerName(g, g.engine.winner()));
     }
     window.draw(info);
 
@@ -435,7 +472,7 @@ void drawEndScreen(sf::RenderWindow& window,
     title.setPosition({tx, 150.f});
     window.draw(title);
 
-    std::string winner = "Winner: " + getPlayerName(g, g.winnerIndex);
+    std::string winner = "Winner: " + getPlayerName(g, g.engine.winner());
     sf::Text wtext(font, winner, 28);
     wtext.setFillColor(sf::Color::White);
     auto wb = wtext.getLocalBounds();
@@ -550,14 +587,23 @@ int main() {
     }
 
     GuiGameState game;
-    initGuiGame(game);
+    initGuiGame(game, randomDealSeed());
 
     std::vector<bool> selected(game.human.handSize(), false);
     std::string errorMsg;
 
     sf::Clock clock;
     bool waitingForAI = false;
-    float aiTriggerTime = 0.f;
+    float aiTriggerTime = 0.f;      // 最早可以出牌的時間（AI_MIN_SHOW 之後）
+
+    // AI 在這個執行緒上思考，畫面照常更新。
+    // 放在 game 後面：先解構（取消並等它結束），才輪到它讀的 game
+    AiWorker aiWorker;
+    int ponderTurn = -1;            // 已經 ponder 過的回合（engine.turnCount），-1 = 還沒
+    // 過了期限先出 bestSoFar 的那一手：engine 已經走了，但 AI 還在讀自己的手牌，
+    // 等 aiWorker 閒下來才真的從手牌拿掉
+    int aiPendingSeat = -1;
+    Move aiPendingMove;
 
     Scene scene = Scene::Start;
 
@@ -600,10 +646,14 @@ int main() {
             }
 
             // Game over: only R / Q
-            if (game.gameOver) {
+            if (game.engine.isTerminal()) {
                 if (auto* k = e.getIf<sf::Event::KeyPressed>()) {
                     if (k->code == sf::Keyboard::Key::R) {
+                        aiWorker.discard();
+                        aiWorker.waitIdle();    // 整個 game 要重建，AI 不能還在讀
+                        aiPendingSeat = -1;
                         resetFullGame(game);
+                        ponderTurn = -1;
                         selected.assign(game.human.handSize(), false);
                         errorMsg.clear();
                         waitingForAI = false;
@@ -621,48 +671,35 @@ int main() {
                 if (auto* k = e.getIf<sf::Event::KeyPressed>()) {
                     if (k->code == sf::Keyboard::Key::Y) {
                         // human is landlord
-                        game.landlordIndex = 0;
-                        for (const auto& c : game.bottomCards) {
-                            game.human.addCard(c);
-                        }
-                        game.human.sortHand();
+                        startRound(game, 0);
+                        ponderTurn = -1;
                         selected.assign(game.human.handSize(), false);
-                        game.currentPlayerIndex = game.landlordIndex;
-                        game.landlordChosen = true;
                         errorMsg.clear();
-
-                        // record initial hand size
-                        for (int i = 0; i < 3; ++i) {
-                            game.initialHandSize[i] = game.players[i]->handSize();
-                        }
                     } else if (k->code == sf::Keyboard::Key::N) {
-                        // random AI landlord
-                        std::random_device rd;
-                        std::mt19937 gen(rd());
-                        std::uniform_int_distribution<int> dist(1, 2);
-                        int aiLandlord = dist(gen);
-
-                        game.landlordIndex = aiLandlord;
-                        for (const auto& c : game.bottomCards) {
-                            game.players[aiLandlord]->addCard(c);
+                        // 兩家 AI 各自用自己的 17 張牌估計當地主的勝率（rollout，
+                        // 合計約 50 ms），比較有把握的那家當地主
+                        const int seats[2] = { 1, 2 };
+                        BidEstimate est[3];
+                        int aiLandlord = BidEvaluator().pickLandlord(
+                            game.deal.hands, seats, 2, randomDealSeed(), est);
+                        for (int seat : seats) {
+                            std::cout << getPlayerName(game, seat) << " bids: "
+                                      << static_cast<int>(est[seat].winRate * 100.0 + 0.5)
+                                      << "% as landlord ("
+                                      << est[seat].rollouts << " rollouts)\n";
                         }
-                        game.players[aiLandlord]->sortHand();
-                        game.currentPlayerIndex = game.landlordIndex;
-                        game.landlordChosen = true;
+
+                        startRound(game, aiLandlord);
+                        ponderTurn = -1;
                         waitingForAI = false;
                         errorMsg.clear();
-
-                        // record initial hand size
-                        for (int i = 0; i < 3; ++i) {
-                            game.initialHandSize[i] = game.players[i]->handSize();
-                        }
                     }
                 }
                 continue;
             }
 
             // Normal game: only human turn listens to controls
-            if (!game.gameOver && game.currentPlayerIndex == 0) {
+            if (!game.engine.isTerminal() && game.engine.currentPlayer() == 0) {
                 if (auto* m = e.getIf<sf::Event::MouseButtonPressed>()) {
                     if (m->button == sf::Mouse::Button::Left) {
                         float mx = static_cast<float>(m->position.x);
@@ -695,6 +732,7 @@ int main() {
                     }
                     else if (k->code == sf::Keyboard::Key::P) {
                         errorMsg.clear();
+                        aiWorker.discard();     // 停掉 ponder（它讀的是 aiView）
                         Move pass;
                         applyMove(game, 0, pass);
                         selected.assign(game.human.handSize(), false);
@@ -715,14 +753,17 @@ int main() {
                             }
                         }
 
+                        aiWorker.discard();     // 停掉 ponder（它讀的是 aiView）
+
                         bool ok = false;
                         std::string msg;
                         Move mv = game.human.playTurnWithIndices(
-                            game.lastMove, idx, ok, msg
+                            game.engine.lastMove(), idx, ok, msg
                         );
 
                         if (!ok) {
                             errorMsg = msg;
+                            ponderTurn = -1;    // 還是你的回合：接著 ponder（同一棵樹）
                         } else {
                             applyMove(game, 0, mv);
                             selected.assign(game.human.handSize(), false);
@@ -733,44 +774,67 @@ int main() {
             }
         }
 
-        // -------- AI logic with delay --------
+        // -------- the AI's own hand catches up once aiWorker is idle --------
+        if (aiPendingSeat >= 0 && !aiWorker.busy()) {
+            Enemy* late = dynamic_cast<Enemy*>(game.players[aiPendingSeat]);
+            if (late) {
+                late->playMove(aiPendingMove);
+            }
+            aiPendingSeat = -1;
+        }
+
+        // -------- pondering: on your turn, the next AI thinks on aiWorker --------
         if (scene == Scene::Game &&
             game.landlordChosen &&
-            !game.gameOver &&
-            game.currentPlayerIndex != 0)
+            !game.engine.isTerminal() &&
+            game.engine.currentPlayer() == 0 &&
+            ponderTurn != game.engine.turnCount() &&
+            !aiWorker.busy() &&
+            aiPendingSeat < 0)
         {
-            float now = clock.getElapsedTime().asSeconds();
-            if (!waitingForAI) {
-                waitingForAI = true;
-                aiTriggerTime = now + 0.8f;
-            } else if (now >= aiTriggerTime) {
-                Enemy* e = dynamic_cast<Enemy*>(game.players[game.currentPlayerIndex]);
-                if (e) {
-                    // compute probability of using bomb/rocket
-                    double prob = 1.0;
-
-                    if (game.lastMove.type != HandType::Pass &&
-                        game.lastMove.type != HandType::Bomb &&
-                        game.lastMove.type != HandType::Rocket &&
-                        game.lastMovePlayerIndex >= 0)
-                    {
-                        int oppIdx  = game.lastMovePlayerIndex;
-                        int current = game.players[oppIdx]->handSize();
-                        int start   = game.initialHandSize[oppIdx];
-                        if (start > 0) {
-                            prob = 1.0 - static_cast<double>(current) /
-                                          static_cast<double>(start);
-                            if (prob < 0.0) prob = 0.0;
-                            if (prob > 1.0) prob = 1.0;
-                        }
-                    }
-
-                    e->setBombDecisionProb(prob);
+            ponderTurn = game.engine.turnCount();
+            Enemy* next = dynamic_cast<Enemy*>(game.players[GameState::nextSeat(0)]);
+            if (next) {
+                refreshAiView(game);
+                aiWorker.ponder(*next, SearchLimits::within(AI_PONDER_MAX * 1000.0));
+            }
+        }
 
-                    Move mv = e->playTurn(game.lastMove);
-                    applyMove(game, game.currentPlayerIndex, mv);
+        // -------- AI logic: thinks on aiWorker, the 0.8s is a minimum display time --------
+        if (scene == Scene::Game &&
+            game.landlordChosen &&
+            !game.engine.isTerminal() &&
+            game.engine.currentPlayer() != 0)
+        {
+            float now = clock.getElapsedTime().asSeconds();
+            int aiIdx = game.engine.currentPlayer();
+            Enemy* e = dynamic_cast<Enemy*>(game.players[aiIdx]);
+            if (e && !waitingForAI) {
+                // 上一個請求（被丟掉的 ponder / 晚到的搜尋）還沒收尾就下一個 frame 再試
+                if (!aiWorker.busy() && aiPendingSeat < 0) {
+                    waitingForAI = true;
+                    aiTriggerTime = now + AI_MIN_SHOW;
+                    // probability of using bomb/rocket
+                    e->setBombDecisionProb(Enemy::bombDecisionProbFor(game.engine));
+                    // 整段顯示時間都拿來搜尋
+                    refreshAiView(game);
+                    aiWorker.start(*e, game.engine.lastMove(),
+                                   SearchLimits::within(AI_MIN_SHOW * 1000.0));
+                }
+            } else if (e) {
+                Move mv;
+                if (now >= aiTriggerTime && aiWorker.poll(mv)) {
+                    applyMove(game, aiIdx, e->playMove(mv));
+                    waitingForAI = false;
+                } else if (now > aiTriggerTime + AI_GRACE) {
+                    // 搜尋沒趕上：出它目前最好的一手，不再等回覆
+                    mv = e->hasBestSoFar() ? e->bestSoFar() : fallbackMove(game.engine);
+                    aiWorker.discard();
+                    applyMove(game, aiIdx, mv);
+                    aiPendingSeat = aiIdx;
+                    aiPendingMove = mv;
+                    waitingForAI = false;
                 }
-                waitingForAI = false;
             }
         }
 
@@ -782,7 +846,7 @@ int main() {
         } else if (scene == Scene::Rules) {
             drawRulesScreen(window, font);
         } else { // Scene::Game
-            if (!game.gameOver) {
+            if (!game.engine.isTerminal()) {
                 drawHumanHand(window, game, selected, font);
                 drawAIPanels(window, game, font);
                 drawActions(window, game, font);
@@ -0,0 +1,726 @@
+// doudizhu_sim: headless AI-vs-AI self-play.
+//
+//   ./doudizhu_sim [--games N] [--threads T] [--seed S] [--bomb-prob P] [--pin 1]
+//                  [--endgame K] [--ismcts-seat K] [--think-ms M] [--playouts N]
+//                  [--tracker 0|1] [--search-threads N] [--parallel root|tree] [--vloss V]
+//                  [--tt-mb N] [--mcts-solve K] [--tablebase FILE] [--reuse 0|1]
+//                  [--deadline-ms D] [--ponder 0|1] [--bid N]
+//                  [--prove C] [--prove-nodes N] [--order C]
+//
+// Plays N full games of Enemy vs Enemy vs Enemy on every core, without any
+// console output from the games themselves, and reports throughput,
+// landlord / peasant win rates, average game length and bomb usage.
+// Game i always uses the same deal and AI random streams for a given seed,
+// so results do not depend on the thread count.
+//
+// --ismcts-seat puts the ISMCTS strategy in one seat (the others stay
+// greedy) and reports its win rate, playouts/sec and decision latency, which
+// is what the per-difficulty think budgets are sized from. With --playouts
+// the search stops on a playout count instead of the clock, so those games
+// are reproducible too. It also reports tree nodes added per second, arena
+// bytes per node and, unless --reuse 0, the root visits kept by re-rooting
+// the previous decision's tree.
+//
+// --deadline-ms gives every decision of the ISMCTS seat a hard deadline
+// (SearchLimits) on top of its think budget, and reports how many turns
+// took longer and the slowest one. Run it with more --search-threads /
+// --threads than cores to see it hold under load.
+//
+// --ponder 1 lets the ISMCTS seat think on the previous seat's turn (with
+// its usual budget) and reports how often the move that came was in the
+// pondered tree (a ponder hit) and how many nodes the decision kept.
+// Compare win rates with --ponder 0 at the same --playouts / --think-ms:
+// the decision itself costs the same, the ponder time is the opponent's.
+//
+// --bid N picks the landlord by bidding instead of at random: each seat
+// estimates its landlord win rate with N rollouts (BidEvaluator) and the
+// highest takes it. It reports the bidding time per deal; the landlord
+// win rate shows how much the bid is worth.
+//
+// --search-threads runs each ISMCTS decision on N threads of the same
+// scheduler that plays the games (nested parallelFor), either as N separate
+// trees (root, reproducible with --playouts) or one shared tree.
+//
+// --tt-mb gives every solver (endgame turns and ISMCTS playout solves, on
+// all threads) one shared transposition table. Solved values are exact, so
+// the results are the same with or without it; the node counts show what
+// it saves.
+//
+// --tablebase maps a file built by doudizhu_tablebase; every AI then plays
+// positions with 1..K cards in each hand straight from the table.
+//
+// --prove C plays no full games: each of the N deals is played greedily
+// down to C cards in total, then proof-number search (df-pn) and the
+// alpha-beta EndgameSolver, with and without a transposition table, all
+// answer "does the landlord win?" for that position. It reports whether
+// they agree, nodes and time for each, on how many positions df-pn was the
+// faster, and the size of the proof trees.
+//
+// --order C plays the same greedy deals down to C cards and solves each
+// position with the endgame solver twice, with and without move ordering
+// (no transposition table), reporting nodes and time for both.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+
+#include "Bidding.h"
+#include "CardTracker.h"
+#include "Character.h"
+#include "Deck.h"
+#include "Engine.h"
+#include "ProofSearch.h"
+#include "Scheduler.h"
+#include "Tablebase.h"
+#include "TransTable.h"
+
+namespace {
+
+struct SimOptions {
+    long long     games     = 100000;
+    unsigned      threads   = 0;     // 0 = all cores
+    std::uint64_t seed      = 1;
+    double        bombProb  = -1.0;  // < 0: Enemy::bombDecisionProbFor
+    bool          pin       = false; // pin worker threads to cores
+    int           endgame   = SolverOptions().maxTotalCards; // 0 = greedy only
+    int           mctsSeat  = -1;    // seat playing ISMCTS, -1 = none
+    double        thinkMs   = 20.0;  // ISMCTS budget per decision
+    long long     playouts  = 0;     // > 0: ISMCTS playout budget instead of time
+    bool          tracker   = true;  // ISMCTS samples hands from the card tracker
+    int           searchThreads = 1; // threads per ISMCTS decision
+    MctsParallel  parallel  = MctsParallel::Root;
+    int           vloss     = 1;     // virtual loss (tree mode)
+    std::size_t   ttMb      = 16;    // shared transposition table, 0 = none
+    int           mctsSolve = 0;     // ISMCTS solves playouts at <= K cards
+    bool          reuse     = true;  // ISMCTS re-roots its last tree
+    double        deadlineMs = 0.0;  // > 0: hard deadline per ISMCTS-seat turn
+    bool          ponder    = false; // ISMCTS seat ponders on the previous seat's turn
+    long long     bid       = 0;     // > 0: landlord by bidding, rollouts per seat
+    std::string   tablebase;         // tablebase file, empty = none
+    int           prove     = 0;     // > 0: proof-search benchmark at <= C cards
+    long long     proveNodes = ProofOptions().maxNodes;
+    int           order     = 0;     // > 0: move-ordering benchmark at <= C cards
+};
+
+struct alignas(64) SimStats { // one per worker: keep them on separate cache lines
+    long long games        = 0;
+    long long landlordWins = 0;
+    long long turns        = 0;
+    long long bombs        = 0;
+    long long rockets      = 0;
+    long long solved       = 0;  // AI turns decided by the endgame solver
+    long long solverNodes  = 0;  // endgame search nodes over those turns
+    long long solverTtHits = 0;
+    long long tablebaseTurns = 0; // AI turns answered by the tablebase
+    long long bidRollouts  = 0;  // --bid: rollouts over all seats
+    double    bidMs        = 0.0;
+
+    // the ISMCTS seat
+    long long mctsWins         = 0;  // games its team won
+    long long mctsLandlord     = 0;  // games it was the landlord
+    long long mctsLandlordWins = 0;
+    long long mctsMoves        = 0;  // decisions searched
+    long long mctsPlayouts     = 0;
+    long long mctsSolved       = 0;  // playouts ended by an exact solve
+    long long mctsSolverNodes  = 0;
+    long long mctsNodes        = 0;  // tree nodes added
+    long long mctsTreeNodes    = 0;  // nodes in the arenas after each decision
+    long long mctsBytes        = 0;  // arena bytes after each decision
+    long long mctsReused       = 0;  // root visits kept by re-rooting
+    long long mctsReusedNodes  = 0;  // tree nodes kept by re-rooting
+    long long ponders          = 0;  // ponder searches
+    long long ponderPlayouts   = 0;
+    long long ponderChecked    = 0;  // searched decisions right after a ponder
+    long long ponderHits       = 0;  // ... that kept the pondered tree
+    double    mctsMs           = 0.0;
+    double    mctsMaxMs        = 0.0;
+    long long lateTurns        = 0;  // turns over --deadline-ms
+    double    turnMaxMs        = 0.0; // slowest whole turn (deadline runs)
+
+    void merge(const SimStats& o) {
+        games        += o.games;
+        landlordWins += o.landlordWins;
+        turns        += o.turns;
+        bombs        += o.bombs;
+        rockets      += o.rockets;
+        solved       += o.solved;
+        solverNodes  += o.solverNodes;
+        solverTtHits += o.solverTtHits;
+        tablebaseTurns += o.tablebaseTurns;
+        bidRollouts  += o.bidRollouts;
+        bidMs        += o.bidMs;
+        mctsWins         += o.mctsWins;
+        mctsLandlord     += o.mctsLandlord;
+        mctsLandlordWins += o.mctsLandlordWins;
+        mctsMoves        += o.mctsMoves;
+        mctsPlayouts     += o.mctsPlayouts;
+        mctsSolved       += o.mctsSolved;
+        mctsSolverNodes  += o.mctsSolverNodes;
+        mctsNodes        += o.mctsNodes;
+        mctsTreeNodes    += o.mctsTreeNodes;
+        mctsBytes        += o.mctsBytes;
+        mctsReused       += o.mctsReused;
+        mctsReusedNodes  += o.mctsReusedNodes;
+        ponders          += o.ponders;
+        ponderPlayouts   += o.ponderPlayouts;
+        ponderChecked    += o.ponderChecked;
+        ponderHits       += o.ponderHits;
+        mctsMs           += o.mctsMs;
+        mctsMaxMs         = std::max(mctsMaxMs, o.mctsMaxMs);
+        lateTurns        += o.lateTurns;
+        turnMaxMs         = std::max(turnMaxMs, o.turnMaxMs);
+    }
+};
+
+// independent, reproducible seed for game `index`
+std::uint64_t gameSeed(std::uint64_t base, long long index) {
+    Xoshiro256 mix(base ^ (static_cast<std::uint64_t>(index) * 0x9E3779B97F4A7C15ull));
+    return mix();
+}
+
+// Per-thread worker: owns its three AIs and their random streams.
+class SimWorker {
+public:
+    SimWorker(const SimOptions& o, TaskScheduler& scheduler, TransTable* table,
+              const Tablebase* tb)
+        : opts(o), tablebase(tb), ai{ Enemy("AI_0"), Enemy("AI_1"), Enemy("AI_2") },
+          bidding(bidOptions(o, scheduler))
+    {
+        for (auto& e : ai) {
+            e.setVerbose(false);
+            // no time budget: the solver result depends only on the position,
+            // so self-play stays reproducible on any machine / thread count
+            e.setEndgameSolver(o.endgame, 0.0);
+        }
+        if (o.mctsSeat >= 0) {
+            MctsOptions mo;
+            mo.budgetMs    = o.playouts > 0 ? 0.0 : o.thinkMs;
+            mo.maxPlayouts = o.playouts;
+            mo.threads     = o.searchThreads;
+            mo.parallel    = o.parallel;
+            mo.virtualLoss = o.vloss;
+            mo.scheduler   = &scheduler;
+            mo.solveCards  = o.mctsSolve;
+            mo.reuseTree   = o.reuse;
+            ai[o.mctsSeat].setSearchOptions(mo);
+            ai[o.mctsSeat].setStrategy(AiStrategy::Ismcts);
+        }
+        for (auto& e : ai) {
+            e.setTranspositionTable(table);
+            e.attachTablebase(tb);
+        }
+    }
+
+    void playGame(long long index, SimStats& stats) {
+        Xoshiro256 rng(gameSeed(opts.seed, index));
+        Deal deal;
+        dealCards(rng, deal);
+        int landlord = static_cast<int>(rng.below(3));
+        if (opts.bid > 0) {
+            static const int seats[3] = { 0, 1, 2 };
+            BidEstimate est[3];
+            landlord = bidding.pickLandlord(deal.hands, seats, 3, rng(), est);
+            for (const BidEstimate& e : est) {
+                stats.bidRollouts += e.rollouts;
+                stats.bidMs       += e.ms;
+            }
+        }
+
+        GameState state;
+        state.start(deal, landlord);
+        CardTracker tracker;
+        tracker.start(deal.bottom, landlord);
+        for (int i = 0; i < 3; ++i) {
+            ai[i].clearHand();
+            ai[i].addCards(state.hand(i));
+            ai[i].seedRng(rng());
+            ai[i].attachState(&state);
+            ai[i].attachTracker(opts.tracker ? &tracker : nullptr);
+        }
+
+        while (!state.isTerminal()) {
+            int seat = state.currentPlayer();
+            Enemy& e = ai[seat];
+            e.setBombDecisionProb(opts.bombProb < 0.0 ? Enemy::bombDecisionProbFor(state)
+                                                      : opts.bombProb);
+            if (tablebase && tablebase->covers(state)) {
+                ++stats.tablebaseTurns;
+            } else if (opts.endgame > 0 && state.totalCards() <= opts.endgame) {
+                ++stats.solved;
+            }
+            if (opts.ponder && opts.mctsSeat >= 0 &&
+                GameState::nextSeat(seat) == opts.mctsSeat) {
+                Enemy& next = ai[opts.mctsSeat];
+                next.ponder(SearchLimits());
+                ++stats.ponders;
+                stats.ponderPlayouts += next.lastPonderStats().playouts;
+            }
+            Move mv;
+            if (seat == opts.mctsSeat && opts.deadlineMs > 0.0) {
+                auto t0 = std::chrono::steady_clock::now();
+                mv = e.playTurn(state.lastMove(), SearchLimits::within(opts.deadlineMs));
+                double ms = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - t0).count();
+                if (ms > opts.deadlineMs) ++stats.lateTurns;
+                stats.turnMaxMs = std::max(stats.turnMaxMs, ms);
+            } else {
+                mv = e.playTurn(state.lastMove());
+            }
+            stats.solverNodes  += e.lastEndgameResult().nodes;
+            stats.solverTtHits += e.lastEndgameResult().ttHits;
+            // greedy, endgame and tablebase turns leave the last search's
+            // stats in place; count only turns that ran ISMCTS
+            if (seat == opts.mctsSeat && e.searchedLastTurn()) {
+                const MctsStats& st = e.lastSearchStats();
+                ++stats.mctsMoves;
+                stats.mctsPlayouts += st.playouts;
+                stats.mctsSolved      += st.solved;
+                stats.mctsSolverNodes += st.solverNodes;
+                stats.mctsNodes       += st.nodes;
+                stats.mctsTreeNodes   += st.treeNodes;
+                stats.mctsBytes       += static_cast<long long>(st.bytes);
+                stats.mctsReused      += st.reusedVisits;
+                stats.mctsReusedNodes += st.reusedNodes;
+                if (st.afterPonder) {
+                    ++stats.ponderChecked;
+                    if (st.ponderHit) ++stats.ponderHits;
+                }
+                stats.mctsMs       += st.ms;
+                stats.mctsMaxMs     = std::max(stats.mctsMaxMs, st.ms);
+            }
+            if (mv.type == HandType::Bomb)   ++stats.bombs;
+            if (mv.type == HandType::Rocket) ++stats.rockets;
+            tracker.observe(state, mv);
+            state.apply(mv);
+        }
+
+        ++stats.games;
+        stats.turns += state.turnCount();
+        if (state.landlordWon()) ++stats.landlordWins;
+        if (opts.mctsSeat >= 0) {
+            bool won = state.sameTeam(opts.mctsSeat, state.winner());
+            if (won) ++stats.mctsWins;
+            if (landlord == opts.mctsSeat) {
+                ++stats.mctsLandlord;
+                if (won) ++stats.mctsLandlordWins;
+            }
+        }
+    }
+
+private:
+    const SimOptions& opts;
+    const Tablebase* tablebase;
+    Enemy ai[3];
+    BidEvaluator bidding;
+
+    // a fixed rollout count, so the landlord depends only on the deal
+    static BidOptions bidOptions(const SimOptions& o, TaskScheduler& scheduler) {
+        BidOptions b;
+        b.budgetMs  = 0.0;
+        b.rollouts  = o.bid > 0 ? o.bid : 1;
+        b.scheduler = &scheduler;
+        return b;
+    }
+};
+
+void usage() {
+    std::cerr << "usage: doudizhu_sim [--games N] [--threads T] [--seed S] [--bomb-prob P] [--pin 1]\n"
+                 "                    [--endgame K] [--ismcts-seat K] [--think-ms M] [--playouts N]\n"
+                 "                    [--tracker 0|1] [--search-threads N] [--parallel root|tree] [--vloss V]\n"
+                 "                    [--tt-mb N] [--mcts-solve K] [--tablebase FILE] [--reuse 0|1]\n"
+                 "                    [--deadline-ms D] [--ponder 0|1] [--bid N]\n"
+                 "  --bomb-prob P  fixed bomb/rocket probability (default: hand-size rule)\n"
+                 "  --pin 1        pin worker threads to CPUs (Linux)\n"
+                 "  --endgame K    exact endgame search at <= K cards left (0 = off, default 15)\n"
+                 "  --ismcts-seat K  seat 0..2 plays ISMCTS, the others greedy\n"
+                 "  --think-ms M   ISMCTS time per decision (default 20)\n"
+                 "  --playouts N   ISMCTS playouts per decision instead of a time budget\n"
+                 "  --tracker 0    ISMCTS samples hidden hands uniformly (ignore played / passes)\n"
+                 "  --search-threads N  threads per ISMCTS decision (default 1)\n"
+                 "  --parallel M   root: one tree per thread (default), tree: one shared tree\n"
+                 "  --vloss V      virtual loss per thread in a shared tree (default 1)\n"
+                 "  --tt-mb N      shared transposition table for all solvers (default 16, 0 = off)\n"
+                 "  --mcts-solve K ISMCTS solves playouts exactly at <= K cards (default 0 = off)\n"
+                 "  --tablebase F  endgame tablebase file from doudizhu_tablebase\n"
+                 "  --reuse 0      ISMCTS starts every decision from an empty tree\n"
+                 "  --deadline-ms D  hard deadline for every turn of the ISMCTS seat\n"
+                 "  --ponder 1     ISMCTS seat thinks on the previous seat's turn too\n"
+                 "  --bid N        landlord by bidding, N rollouts per seat (default 0 = random)\n"
+                 "  --prove C      compare df-pn proof search with the endgame solver at C cards\n"
+                 "  --prove-nodes N  proof-search node budget (default 2000000)\n"
+                 "  --order C      endgame search nodes with / without move ordering at C cards\n";
+}
+
+bool parseArgs(int argc, char* argv[], SimOptions& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string v = argv[++i];
+        if (a == "--games") {
+            o.games = std::stoll(v);
+        } else if (a == "--threads") {
+            o.threads = static_cast<unsigned>(std::stoul(v));
+        } else if (a == "--seed") {
+            o.seed = std::stoull(v);
+        } else if (a == "--bomb-prob") {
+            o.bombProb = std::stod(v);
+        } else if (a == "--pin") {
+            o.pin = (v != "0");
+        } else if (a == "--endgame") {
+            o.endgame = std::stoi(v);
+        } else if (a == "--ismcts-seat") {
+            o.mctsSeat = std::stoi(v);
+        } else if (a == "--think-ms") {
+            o.thinkMs = std::stod(v);
+        } else if (a == "--playouts") {
+            o.playouts = std::stoll(v);
+        } else if (a == "--tracker") {
+            o.tracker = (v != "0");
+        } else if (a == "--search-threads") {
+            o.searchThreads = std::stoi(v);
+        } else if (a == "--parallel") {
+            if (v == "root") {
+                o.parallel = MctsParallel::Root;
+            } else if (v == "tree") {
+                o.parallel = MctsParallel::Tree;
+            } else {
+                return false;
+            }
+        } else if (a == "--vloss") {
+            o.vloss = std::stoi(v);
+        } else if (a == "--tt-mb") {
+            o.ttMb = static_cast<std::size_t>(std::stoul(v));
+        } else if (a == "--mcts-solve") {
+            o.mctsSolve = std::stoi(v);
+        } else if (a == "--deadline-ms") {
+            o.deadlineMs = std::stod(v);
+        } else if (a == "--bid") {
+            o.bid = std::stoll(v);
+        } else if (a == "--ponder") {
+            o.ponder = (v != "0");
+        } else if (a == "--reuse") {
+            o.reuse = (v != "0");
+        } else if (a == "--tablebase") {
+            o.tablebase = v;
+        } else if (a == "--prove") {
+            o.prove = std::stoi(v);
+        } else if (a == "--prove-nodes") {
+            o.proveNodes = std::stoll(v);
+        } else if (a == "--order") {
+            o.order = std::stoi(v);
+        } else {
+            return false;
+        }
+    }
+    return o.games > 0 && o.mctsSeat >= -1 && o.mctsSeat <= 2 &&
+           (o.thinkMs > 0.0 || o.playouts > 0) && o.searchThreads >= 1 && o.vloss >= 1 &&
+           o.mctsSolve >= 0 && o.prove >= 0 && o.proveNodes > 0 &&
+           o.order >= 0;
+}
+
+// Plays deal `g` greedily until at most `cards` cards are left, into `state`
+// (which the AIs keep pointing at). False if the game ended before that.
+bool greedyPosition(const SimOptions& opts, long long g, int cards, Enemy ai[3], GameState& state) {
+    Xoshiro256 rng(gameSeed(opts.seed, g));
+    Deal deal;
+    dealCards(rng, deal);
+    state.start(deal, static_cast<int>(rng.below(3)));
+    for (int i = 0; i < 3; ++i) {
+        ai[i].clearHand();
+        ai[i].addCards(state.hand(i));
+        ai[i].seedRng(rng());
+        ai[i].attachState(&state);
+        ai[i].attachTracker(nullptr);
+    }
+    while (!state.isTerminal() && state.totalCards() > cards) {
+        state.apply(ai[state.currentPlayer()].playTurn(state.lastMove()));
+    }
+    return !state.isTerminal();
+}
+
+// --prove: one thread, so the timings compare like with like. df-pn keeps
+// its table from one position to the next, so alpha-beta also runs a
+// second time with a transposition table of the same size.
+int runProve(const SimOptions& opts) {
+    ProofOptions po;
+    po.maxNodes = opts.proveNodes;
+    ProofNumberSearch pns(po);
+    SolverOptions so;
+    so.maxTotalCards = opts.prove;
+    so.budgetMs      = 0.0;
+    EndgameSolver solver(so);
+    TransTable table(po.tableMb);
+    so.table = &table;
+    EndgameSolver tableSolver(so);
+
+    Enemy ai[3] = { Enemy("AI_0"), Enemy("AI_1"), Enemy("AI_2") };
+    for (auto& e : ai) {
+        e.setVerbose(false);
+        e.setEndgameSolver(0, 0.0);
+    }
+
+    long long positions = 0, agree = 0, unknown = 0, proven = 0, proofs = 0;
+    long long faster = 0, fasterTable = 0;
+    long long pnsNodes = 0, abNodes = 0, ttNodes = 0, proofNodes = 0;
+    double pnsMs = 0.0, proofMs = 0.0, abMs = 0.0, ttMs = 0.0;
+    for (long long g = 0; g < opts.games; ++g) {
+        GameState state;
+        if (!greedyPosition(opts, g, opts.prove, ai, state)) {
+            continue;
+        }
+
+        ++positions;
+        ProofResult pr = pns.landlordWins(state);
+        SolverResult sr = solver.solve(state);
+        SolverResult tr = tableSolver.solve(state);
+        bool abLandlord = (sr.win == state.sameTeam(state.currentPlayer(), state.landlord()));
+        pnsNodes += pr.nodes;
+        pnsMs    += pr.ms;
+        proofMs  += pr.proofMs;
+        abNodes  += sr.nodes;
+        abMs     += sr.ms;
+        ttNodes  += tr.nodes;
+        ttMs     += tr.ms;
+        if (pr.ms < sr.ms) ++faster;
+        if (pr.ms < tr.ms) ++fasterTable;
+        if (pr.status == ProofStatus::Unknown) {
+            ++unknown;
+            continue;
+        }
+        if ((pr.status == ProofStatus::Proven) == abLandlord) ++agree;
+        if (pr.status == ProofStatus::Proven) ++proven;
+        if (!pr.proof.empty()) {
+            ++proofs;
+            proofNodes += static_cast<long long>(pr.proof.nodes.size());
+        }
+    }
+
+    double n = positions > 0 ? static_cast<double>(positions) : 1.0;
+    long long settled = positions - unknown;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "positions:        " << positions << " at <= " << opts.prove << " cards\n";
+    std::cout << "settled by df-pn: " << settled << " (" << unknown << " over the node budget)\n";
+    std::cout << "agree with a-b:   " << agree << " / " << settled << "\n";
+    std::cout << "landlord wins:    " << 100.0 * proven / (settled > 0 ? settled : 1) << " %\n";
+    std::cout << "df-pn:            " << pnsNodes / n << " nodes, " << pnsMs / n << " ms avg ("
+              << proofMs / n << " ms of it writing the proof)\n";
+    std::cout << "alpha-beta:       " << abNodes / n << " nodes, " << abMs / n << " ms avg\n";
+    std::cout << "a-b with table:   " << ttNodes / n << " nodes, " << ttMs / n << " ms avg\n";
+    std::cout << "speedup:          " << (pnsMs > 0.0 ? abMs / pnsMs : 0.0) << "x over alpha-beta, "
+              << (pnsMs > 0.0 ? ttMs / pnsMs : 0.0) << "x over a-b with table\n";
+    std::cout << "df-pn faster on:  " << faster << " / " << positions << " positions ("
+              << fasterTable << " against a-b with table)\n";
+    std::cout << "proof tree:       " << proofNodes / static_cast<double>(proofs > 0 ? proofs : 1)
+              << " moves avg (" << settled - proofs << " over " << opts.proveNodes << " moves left out)\n";
+    return agree == settled ? 0 : 1;
+}
+
+// --order: the same alpha-beta search with and without move ordering, no
+// table, one thread
+int runOrdering(const SimOptions& opts) {
+    SolverOptions so;
+    so.maxTotalCards = opts.order;
+    so.budgetMs      = 0.0;
+    EndgameSolver ordered(so);
+    so.ordering = false;
+    EndgameSolver plain(so);
+
+    Enemy ai[3] = { Enemy("AI_0"), Enemy("AI_1"), Enemy("AI_2") };
+    for (auto& e : ai) {
+        e.setVerbose(false);
+        e.setEndgameSolver(0, 0.0);
+    }
+
+    long long positions = 0, agree = 0, fewer = 0;
+    long long orderedNodes = 0, plainNodes = 0;
+    double orderedMs = 0.0, plainMs = 0.0;
+    for (long long g = 0; g < opts.games; ++g) {
+        GameState state;
+        if (!greedyPosition(opts, g, opts.order, ai, state)) {
+            continue;
+        }
+        ++positions;
+        SolverResult a = ordered.solve(state);
+        SolverResult b = plain.solve(state);
+        if (a.win == b.win) ++agree;
+        if (a.nodes < b.nodes) ++fewer;
+        orderedNodes += a.nodes;
+        orderedMs    += a.ms;
+        plainNodes   += b.nodes;
+        plainMs      += b.ms;
+    }
+
+    // regression: a rocket in hand (main rank 100) must stay inside the
+    // history table. The landlord leads with the rocket, a pair of 3s and a
+    // 4; the peasants hold a bomb of 2s and a few low cards.
+    {
+        CardSet hands[3];
+        hands[0] = CardSet::ofRank(16) | CardSet::ofRank(17) |
+                   CardSet::ofRank(3).takeOfRank(3, 2) | CardSet::ofRank(4).takeOfRank(4, 1);
+        hands[1] = CardSet::ofRank(15) | CardSet::ofRank(5).takeOfRank(5, 1);
+        hands[2] = CardSet::ofRank(6).takeOfRank(6, 2) | CardSet::ofRank(7).takeOfRank(7, 1);
+        GameState state;
+        state.reset(hands, 0);
+        SolverResult a = ordered.solve(state);
+        SolverResult b = plain.solve(state);
+        bool same = (a.win == b.win);
+        std::cout << "rocket position:  " << (same ? "same result" : "MISMATCH") << "\n";
+        if (!same) {
+            return 1;
+        }
+    }
+
+    double n = positions > 0 ? static_cast<double>(positions) : 1.0;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "positions:        " << positions << " at <= " << opts.order << " cards\n";
+    std::cout << "same result:      " << agree << " / " << positions << "\n";
+    std::cout << "ordering on:      " << orderedNodes / n << " nodes, " << orderedMs / n << " ms avg\n";
+    std::cout << "ordering off:     " << plainNodes / n << " nodes, " << plainMs / n << " ms avg\n";
+    std::cout << "node reduction:   " << (orderedNodes > 0 ? static_cast<double>(plainNodes) / orderedNodes : 0.0)
+              << "x (fewer nodes on " << fewer << " positions)\n";
+    return agree == positions ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    SimOptions opts;
+    try {
+        if (!parseArgs(argc, argv, opts)) {
+            usage();
+            return 1;
+        }
+    } catch (const std::exception&) {
+        usage();
+        return 1;
+    }
+
+    if (opts.prove > 0) {
+        return runProve(opts);
+    }
+    if (opts.order > 0) {
+        return runOrdering(opts);
+    }
+
+    TaskScheduler scheduler(opts.threads, opts.pin);
+    unsigned threads = scheduler.threadCount();
+
+    std::unique_ptr<TransTable> table;
+    if (opts.ttMb > 0) {
+        table = std::make_unique<TransTable>(opts.ttMb);
+    }
+    Tablebase tablebase;
+    if (!opts.tablebase.empty() && !tablebase.open(opts.tablebase)) {
+        std::cerr << "cannot open tablebase " << opts.tablebase << "\n";
+        return 1;
+    }
+    const Tablebase* tb = tablebase.loaded() ? &tablebase : nullptr;
+
+    // one AI trio and one stats block per worker thread and nesting level:
+    // a thread waiting in a nested parallelFor (--search-threads) may start
+    // another game, which must not take over the AIs of the game it
+    // interrupted. Games are handed out by work stealing, 16 at a time.
+    struct alignas(64) ThreadSims {
+        int depth = 0;
+        std::vector<std::unique_ptr<SimWorker>> levels;
+        std::vector<std::unique_ptr<SimStats>>  stats;
+    };
+    std::vector<ThreadSims> perThread(threads);
+
+    auto t0 = std::chrono::steady_clock::now();
+    scheduler.parallelFor(static_cast<std::size_t>(opts.games), 16,
+        [&](std::size_t g, unsigned worker) {
+            ThreadSims& ts = perThread[worker];
+            std::size_t level = static_cast<std::size_t>(ts.depth++);
+            if (level == ts.levels.size()) {
+                ts.levels.push_back(std::make_unique<SimWorker>(opts, scheduler, table.get(), tb));
+                ts.stats.push_back(std::make_unique<SimStats>());
+            }
+            ts.levels[level]->playGame(static_cast<long long>(g), *ts.stats[level]);
+            --ts.depth;
+        });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    SimStats total;
+    for (const auto& ts : perThread) {
+        for (const auto& s : ts.stats) {
+            total.merge(*s);
+        }
+    }
+
+    double n = static_cast<double>(total.games);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "games:            " << total.games << " on " << threads << " threads\n";
+    std::cout << "time:             " << secs << " s  (" << n / secs << " games/s)\n";
+    std::cout << "landlord wins:    " << 100.0 * total.landlordWins / n << " %\n";
+    std::cout << "peasant wins:     " << 100.0 * (total.games - total.landlordWins) / n << " %\n";
+    if (opts.bid > 0) {
+        std::cout << "bidding:          " << total.bidRollouts / n << " rollouts, "
+                  << total.bidMs / n << " ms per deal\n";
+    }
+    std::cout << "avg game length:  " << total.turns / n << " turns\n";
+    std::cout << "bombs per game:   " << total.bombs / n << "\n";
+    std::cout << "rockets per game: " << total.rockets / n << "\n";
+    std::cout << "endgame turns:    " << total.solved / n << " per game (<= " << opts.endgame << " cards)\n";
+    std::cout << "endgame nodes:    " << total.solverNodes / n << " per game, "
+              << total.solverTtHits / n << " table hits\n";
+    if (tb) {
+        std::cout << "tablebase turns:  " << total.tablebaseTurns / n << " per game (<= "
+                  << tb->maxCards() << " cards a hand)\n";
+    }
+    if (table) {
+        std::cout << "trans. table:     " << table->bytes() / (1024 * 1024) << " MB, "
+                  << table->usagePermille() / 10.0 << " % used\n";
+    }
+    if (opts.mctsSeat >= 0) {
+        double moves = total.mctsMoves > 0 ? static_cast<double>(total.mctsMoves) : 1.0;
+        long long peasantGames = total.games - total.mctsLandlord;
+        std::cout << "ISMCTS seat " << opts.mctsSeat << ":\n";
+        std::cout << "  wins:           " << 100.0 * total.mctsWins / n << " %  (landlord "
+                  << (total.mctsLandlord ? 100.0 * total.mctsLandlordWins / total.mctsLandlord : 0.0)
+                  << " %, peasant "
+                  << (peasantGames ? 100.0 * (total.mctsWins - total.mctsLandlordWins) / peasantGames : 0.0)
+                  << " %)\n";
+        std::cout << "  decisions:      " << total.mctsMoves << "\n";
+        std::cout << "  latency:        " << total.mctsMs / moves << " ms avg, "
+                  << total.mctsMaxMs << " ms max\n";
+        std::cout << "  playouts:       " << total.mctsPlayouts / moves << " per decision, "
+                  << (total.mctsMs > 0.0 ? total.mctsPlayouts * 1000.0 / total.mctsMs : 0.0)
+                  << " per second\n";
+        std::cout << "  tree:           " << total.mctsNodes / moves << " nodes per decision, "
+                  << (total.mctsMs > 0.0 ? total.mctsNodes * 1000.0 / total.mctsMs : 0.0)
+                  << " per second, "
+                  << (total.mctsTreeNodes ? total.mctsBytes / static_cast<double>(total.mctsTreeNodes) : 0.0)
+                  << " bytes per node\n";
+        if (opts.deadlineMs > 0.0) {
+            std::cout << "  deadline:       " << total.lateTurns << " turns over " << opts.deadlineMs
+                      << " ms, slowest " << total.turnMaxMs << " ms\n";
+        }
+        if (opts.reuse) {
+            std::cout << "  reused:         " << total.mctsReused / moves
+                      << " root visits, " << total.mctsReusedNodes / moves
+                      << " nodes per decision\n";
+        }
+        if (opts.ponder) {
+            std::cout << "  ponder:         " << total.ponders << " searches, "
+                      << (total.ponders ? total.ponderPlayouts / static_cast<double>(total.ponders) : 0.0)
+                      << " playouts each; hit "
+                      << (total.ponderChecked ? 100.0 * total.ponderHits / total.ponderChecked : 0.0)
+                      << " % of " << total.ponderChecked << " decisions after one\n";
+        }
+        if (opts.mctsSolve > 0) {
+            std::cout << "  solved:         " << total.mctsSolved / moves << " playouts per decision, "
+                      << (total.mctsSolved ? total.mctsSolverNodes / static_cast<double>(total.mctsSolved) : 0.0)
+                      << " nodes each\n";
+        }
+    }
+    return 0;
+}
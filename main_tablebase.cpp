@@ -0,0 +1,154 @@
+// doudizhu_tablebase: build the endgame tablebase file.
+//
+//   ./doudizhu_tablebase [--k K] [--out FILE] [--threads T] [--verify N] [--max-mb M]
+//
+// Solves every position with 1..K cards in each hand by retrograde
+// analysis on all cores and writes FILE (default doudizhu.tb), which the
+// AIs map at startup. --verify N then checks N positions from random
+// play-outs against the exact EndgameSolver. --max-mb refuses to build
+// anything larger (K = 3 would need about 10 GB).
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "Deck.h"
+#include "Engine.h"
+#include "Rng.h"
+#include "Scheduler.h"
+#include "Solver.h"
+#include "Tablebase.h"
+
+namespace {
+
+struct ToolOptions {
+    int           k       = 2;
+    std::string   out     = Tablebase::kDefaultFile;
+    unsigned      threads = 0;      // 0 = all cores
+    long long     verify  = 10000;
+    std::uint64_t maxMb   = 1024;
+};
+
+void usage() {
+    std::cerr << "usage: doudizhu_tablebase [--k K] [--out FILE] [--threads T] [--verify N] [--max-mb M]\n"
+                 "  --k K        cards per hand, 1..4 (default 2)\n"
+                 "  --out FILE   output file (default " << Tablebase::kDefaultFile << ")\n"
+                 "  --verify N   positions checked against the exact solver (default 10000)\n"
+                 "  --max-mb M   refuse to build a larger file (default 1024)\n";
+}
+
+bool parseArgs(int argc, char* argv[], ToolOptions& o) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string v = argv[++i];
+        if (a == "--k") {
+            o.k = std::stoi(v);
+        } else if (a == "--out") {
+            o.out = v;
+        } else if (a == "--threads") {
+            o.threads = static_cast<unsigned>(std::stoul(v));
+        } else if (a == "--verify") {
+            o.verify = std::stoll(v);
+        } else if (a == "--max-mb") {
+            o.maxMb = std::stoull(v);
+        } else {
+            return false;
+        }
+    }
+    return o.k >= 1 && o.k <= Tablebase::kMaxK && o.verify >= 0;
+}
+
+// Random positions inside the table: deal K + 2 cards a seat, play random
+// moves until every hand is down to 1..K cards.
+long long verify(const Tablebase& tb, long long count) {
+    Xoshiro256 rng(12345);
+    SolverOptions so;
+    so.maxTotalCards = 3 * tb.maxCards();
+    so.budgetMs      = 0.0;
+    EndgameSolver solver(so);
+    MoveList moves;
+    long long checked = 0;
+    long long wrong = 0;
+    while (checked < count) {
+        Deal deal;
+        dealCards(rng, deal);
+        CardSet hands[3];
+        for (int i = 0; i < 3; ++i) {
+            for (CardId id : deal.hands[i]) {
+                if (hands[i].size() == tb.maxCards() + 2) break;
+                hands[i].add(id);
+            }
+        }
+        GameState s;
+        s.reset(hands, static_cast<int>(rng.below(3)));
+        while (!s.isTerminal()) {
+            if (tb.covers(s)) {
+                ++checked;
+                if (tb.win(s) != solver.solve(s).win) {
+                    ++wrong;
+                }
+            }
+            int n = s.legalMoves(moves);
+            s.apply(moves[static_cast<int>(rng.below(static_cast<std::uint32_t>(n)))]);
+        }
+    }
+    return wrong;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    ToolOptions opts;
+    try {
+        if (!parseArgs(argc, argv, opts)) {
+            usage();
+            return 1;
+        }
+    } catch (const std::exception&) {
+        usage();
+        return 1;
+    }
+
+    const std::uint64_t bytes = Tablebase::fileBytes(opts.k);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "K = " << opts.k << ": " << bytes / (1024.0 * 1024.0) << " MB\n";
+    if (bytes > opts.maxMb * 1024 * 1024) {
+        std::cerr << "larger than --max-mb " << opts.maxMb << ", not building\n";
+        return 1;
+    }
+
+    TaskScheduler scheduler(opts.threads);
+    Tablebase tb;
+    auto t0 = std::chrono::steady_clock::now();
+    tb.build(opts.k, scheduler);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "positions:  " << tb.positions() << " in " << secs << " s on "
+              << scheduler.threadCount() << " threads ("
+              << tb.positions() / secs / 1e6 << " M/s)\n";
+
+    if (!tb.save(opts.out)) {
+        std::cerr << "cannot write " << opts.out << "\n";
+        return 1;
+    }
+    std::cout << "written:    " << opts.out << "\n";
+
+    if (opts.verify > 0) {
+        Tablebase mapped;
+        if (!mapped.open(opts.out)) {
+            std::cerr << "cannot map " << opts.out << " back\n";
+            return 1;
+        }
+        long long wrong = verify(mapped, opts.verify);
+        std::cout << "verified:   " << opts.verify << " positions vs. the solver, "
+                  << wrong << " mismatches\n";
+        if (wrong != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}